@@ -0,0 +1,212 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+/* synthetic X clients for the benchmark. Each mode prints one latency in
+ * microseconds per line to stdout, errors go to stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/select.h>
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/keysym.h>
+#include <X11/extensions/XTest.h>
+
+// how long to wait for the window manager before giving up
+#define BENCH_TIMEOUT_USEC 5000000
+
+static Display* g_display;
+
+static long now_usec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+// waits for the next event until deadline, returns false on timeout
+static bool next_event(XEvent* event, long deadline) {
+    while (!XPending(g_display)) {
+        long remaining = deadline - now_usec();
+        if (remaining <= 0) {
+            return false;
+        }
+        int fd = ConnectionNumber(g_display);
+        fd_set in_fds;
+        FD_ZERO(&in_fds);
+        FD_SET(fd, &in_fds);
+        struct timeval tv = { remaining / 1000000, remaining % 1000000 };
+        select(fd + 1, &in_fds, NULL, NULL, &tv);
+    }
+    XNextEvent(g_display, event);
+    return true;
+}
+
+static int window_index(Window* wins, int count, Window win) {
+    for (int i = 0; i < count; i++) {
+        if (wins[i] == win) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static Window* create_windows(int count) {
+    Window* wins = calloc(count, sizeof(Window));
+    Window root = DefaultRootWindow(g_display);
+    XClassHint hint = { "bench-client", "BenchClient" };
+    for (int i = 0; i < count; i++) {
+        wins[i] = XCreateSimpleWindow(g_display, root, 0, 0, 100, 100, 0, 0, 0);
+        XSetClassHint(g_display, wins[i], &hint);
+        XSelectInput(g_display, wins[i], StructureNotifyMask);
+    }
+    return wins;
+}
+
+/* maps or unmaps all windows and prints for each window the time until the
+ * corresponding notify event arrived. Returns false on timeout.
+ */
+static bool map_all(Window* wins, int count, bool map) {
+    long* begin = calloc(count, sizeof(long));
+    int remaining = count;
+    for (int i = 0; i < count; i++) {
+        begin[i] = now_usec();
+        if (map) {
+            XMapWindow(g_display, wins[i]);
+        } else {
+            XUnmapWindow(g_display, wins[i]);
+        }
+    }
+    XFlush(g_display);
+    long deadline = now_usec() + BENCH_TIMEOUT_USEC;
+    int type = map ? MapNotify : UnmapNotify;
+    XEvent ev;
+    while (remaining > 0 && next_event(&ev, deadline)) {
+        int i = window_index(wins, count, ev.xany.window);
+        if (ev.type != type || i < 0 || begin[i] < 0) {
+            continue;
+        }
+        printf("%ld\n", now_usec() - begin[i]);
+        begin[i] = -1;
+        remaining--;
+    }
+    free(begin);
+    if (remaining > 0) {
+        fprintf(stderr, "bench-clients: %d windows timed out\n", remaining);
+    }
+    return remaining == 0;
+}
+
+// map and unmap COUNT windows ROUNDS times
+static int mode_map(int count, int rounds) {
+    Window* wins = create_windows(count);
+    for (int r = 0; r < rounds; r++) {
+        if (!map_all(wins, count, true) || !map_all(wins, count, false)) {
+            return EXIT_FAILURE;
+        }
+    }
+    free(wins);
+    return EXIT_SUCCESS;
+}
+
+// map COUNT windows and keep them until the process is killed
+static int mode_hold(int count) {
+    Window* wins = create_windows(count);
+    if (!map_all(wins, count, true)) {
+        return EXIT_FAILURE;
+    }
+    fflush(stdout);
+    for (;;) {
+        pause();
+    }
+    return EXIT_SUCCESS;
+}
+
+/* drags a window with Mod4-Button1 by STEPS pixels and prints the time
+ * until the window manager moved it after each step
+ */
+static int mode_drag(int steps) {
+    int event_base, error_base, major, minor;
+    if (!XTestQueryExtension(g_display, &event_base, &error_base,
+                             &major, &minor)) {
+        fprintf(stderr, "bench-clients: XTest is not available\n");
+        return EXIT_FAILURE;
+    }
+    Window* win = create_windows(1);
+    if (!map_all(win, 1, true)) {
+        return EXIT_FAILURE;
+    }
+    XWindowAttributes wa;
+    XGetWindowAttributes(g_display, *win, &wa);
+    int x, y;
+    Window child;
+    XTranslateCoordinates(g_display, *win, wa.root, wa.width / 2,
+                          wa.height / 2, &x, &y, &child);
+    KeyCode mod = XKeysymToKeycode(g_display, XK_Super_L);
+    XTestFakeMotionEvent(g_display, -1, x, y, CurrentTime);
+    XTestFakeKeyEvent(g_display, mod, True, CurrentTime);
+    XTestFakeButtonEvent(g_display, 1, True, CurrentTime);
+    XSync(g_display, False);
+    int failures = 0;
+    for (int i = 1; i <= steps; i++) {
+        long begin = now_usec();
+        XTestFakeMotionEvent(g_display, -1, x + i, y + i, CurrentTime);
+        XFlush(g_display);
+        long deadline = begin + BENCH_TIMEOUT_USEC / 50;
+        XEvent ev;
+        bool moved = false;
+        while (!moved && next_event(&ev, deadline)) {
+            moved = ev.type == ConfigureNotify && ev.xany.window == *win;
+        }
+        if (moved) {
+            printf("%ld\n", now_usec() - begin);
+        } else {
+            failures++;
+        }
+    }
+    XTestFakeButtonEvent(g_display, 1, False, CurrentTime);
+    XTestFakeKeyEvent(g_display, mod, False, CurrentTime);
+    XSync(g_display, False);
+    free(win);
+    if (failures > 0) {
+        fprintf(stderr, "bench-clients: %d of %d drag steps timed out\n",
+                failures, steps);
+    }
+    return failures < steps ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stderr,
+            "Usage: %s map COUNT ROUNDS\n"
+            "       %s hold COUNT\n"
+            "       %s drag STEPS\n", argv[0], argv[0], argv[0]);
+        return EXIT_FAILURE;
+    }
+    g_display = XOpenDisplay(NULL);
+    if (!g_display) {
+        fprintf(stderr, "bench-clients: Cannot open display\n");
+        return EXIT_FAILURE;
+    }
+    int status;
+    if (!strcmp(argv[1], "map") && argc >= 4) {
+        status = mode_map(atoi(argv[2]), atoi(argv[3]));
+    } else if (!strcmp(argv[1], "hold")) {
+        status = mode_hold(atoi(argv[2]));
+    } else if (!strcmp(argv[1], "drag")) {
+        status = mode_drag(atoi(argv[2]));
+    } else {
+        fprintf(stderr, "bench-clients: Unknown mode \"%s\"\n", argv[1]);
+        status = EXIT_FAILURE;
+    }
+    XCloseDisplay(g_display);
+    return status;
+}
+
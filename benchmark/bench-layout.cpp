@@ -0,0 +1,201 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+/* micro benchmark of the layout computations. It only links the X-free
+ * layout core (src/layout-engine.cpp and src/geometry.cpp) and thus runs
+ * without an X server. For each scenario one JSON object is printed per line:
+ *
+ *   {"scenario":"grid","rounds":1000,"usec":5310,"nsec_per_round":5310,
+ *    "checksum":1498733}
+ *
+ * The checksum is computed from the results, so it only changes if the
+ * computed geometry changes.
+ *
+ * usage: bench-layout [-r ROUNDS] [SCENARIO ...]
+ */
+
+#include "layout-engine.h"
+#include "geometry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vector>
+
+// all scenarios lay out on a screen of this size
+static const Rectangle g_screen(0, 0, 1920, 1080);
+
+static long now_usec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+static unsigned long rect_checksum(Rectangle r) {
+    return (unsigned long)(r.x * 7 + r.y * 13 + r.width * 17 + r.height * 19);
+}
+
+// lays out a balanced split tree of the given depth, with three clients in
+// each leaf, as frame_apply_layout() does
+static unsigned long layout_split_tree(Rectangle rect, int depth,
+                                       Rectangle* clients) {
+    if (depth <= 0) {
+        HSLayoutParams params;
+        params.count = 3;
+        params.selection = 0;
+        params.gapless_grid = true;
+        rect = layout_frame_inner_rect(rect, 5, 2);
+        if (!layout_smart_surroundings(true, params.count, LAYOUT_VERTICAL)) {
+            rect = layout_client_area(rect, 5, 2);
+        }
+        layout_engine(LAYOUT_VERTICAL)->compute(rect, &params, clients);
+        return rect_checksum(clients[params.count - 1]);
+    }
+    Rectangle first, second;
+    int fraction = FRACTION_UNIT / 2 + depth * 100;
+    layout_split(rect, depth % 2, fraction, &first, &second);
+    return layout_split_tree(first, depth - 1, clients)
+         + layout_split_tree(second, depth - 1, clients);
+}
+
+static unsigned long scenario_split_tree(int rounds) {
+    Rectangle clients[3];
+    unsigned long sum = 0;
+    for (int i = 0; i < rounds; i++) {
+        sum += layout_split_tree(g_screen, 12, clients);
+    }
+    return sum;
+}
+
+static unsigned long scenario_layout(int layout, size_t count, int rounds) {
+    std::vector<Rectangle> rects(count);
+    HSLayoutParams params;
+    params.count = count;
+    params.selection = 0;
+    params.gapless_grid = true;
+    unsigned long sum = 0;
+    for (int i = 0; i < rounds; i++) {
+        layout_engine(layout)->compute(g_screen, &params, rects.data());
+        sum += rect_checksum(rects[i % count]);
+    }
+    return sum;
+}
+
+static unsigned long scenario_grid(int rounds) {
+    return scenario_layout(LAYOUT_GRID, 1000, rounds);
+}
+
+static unsigned long scenario_linear(int rounds) {
+    return scenario_layout(LAYOUT_HORIZONTAL, 1000, rounds);
+}
+
+// searches neighbours in all directions among the windows of a 1000 client
+// grid, as the focus command does for floating windows
+static unsigned long scenario_direction(int rounds) {
+    const size_t count = 1000;
+    std::vector<Rectangle> cells(count);
+    HSLayoutParams params;
+    params.count = count;
+    params.selection = 0;
+    params.gapless_grid = false;
+    layout_engine(LAYOUT_GRID)->compute(g_screen, &params, cells.data());
+    std::vector<RectangleIdx> rects(count);
+    unsigned long sum = 0;
+    for (int i = 0; i < rounds; i++) {
+        // the search modifies the buffer, so it is filled for each search
+        for (size_t j = 0; j < count; j++) {
+            rects[j].r = cells[j];
+            rects[j].idx = j;
+        }
+        enum HSDirection dir = (enum HSDirection)(i % 4);
+        int found = find_rectangle_in_direction(rects.data(), count,
+                                                i % count, dir);
+        sum += found + 1;
+    }
+    return sum;
+}
+
+static unsigned long scenario_sizehints(int rounds) {
+    HSSizeHints hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.basew = hints.minw = 20;
+    hints.baseh = hints.minh = 10;
+    hints.incw = 7;
+    hints.inch = 15;
+    hints.mina = 0.5;
+    hints.maxa = 2.0;
+    unsigned long sum = 0;
+    for (int i = 0; i < rounds; i++) {
+        int w = 100 + i % 1000;
+        int h = 100 + (i * 7) % 1000;
+        size_hints_apply(&hints, &w, &h);
+        sum += w + h;
+    }
+    return sum;
+}
+
+typedef struct {
+    const char* name;
+    unsigned long (*run)(int rounds);
+    int rounds_factor; // how many rounds relative to the -r argument
+} Scenario;
+
+static Scenario g_scenarios[] = {
+    { "split_tree",   scenario_split_tree,  1     },
+    { "grid",         scenario_grid,        10    },
+    { "linear",       scenario_linear,      10    },
+    { "direction",    scenario_direction,   10    },
+    { "sizehints",    scenario_sizehints,   10000 },
+};
+
+static void run_scenario(Scenario* scenario, int rounds) {
+    rounds *= scenario->rounds_factor;
+    long begin = now_usec();
+    unsigned long checksum = scenario->run(rounds);
+    long usec = now_usec() - begin;
+    printf("{\"scenario\":\"%s\",\"rounds\":%d,\"usec\":%ld,"
+           "\"nsec_per_round\":%ld,\"checksum\":%lu}\n",
+           scenario->name, rounds, usec,
+           rounds > 0 ? usec * 1000 / rounds : 0, checksum);
+}
+
+int main(int argc, char** argv) {
+    int rounds = 100;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:")) != -1) {
+        switch (opt) {
+            case 'r':
+                rounds = atoi(optarg);
+                break;
+            default:
+                return EXIT_FAILURE;
+        }
+    }
+    size_t scenario_count = sizeof(g_scenarios) / sizeof(*g_scenarios);
+    if (optind >= argc) {
+        for (size_t i = 0; i < scenario_count; i++) {
+            run_scenario(g_scenarios + i, rounds);
+        }
+        return EXIT_SUCCESS;
+    }
+    for (int a = optind; a < argc; a++) {
+        size_t i;
+        for (i = 0; i < scenario_count; i++) {
+            if (!strcmp(argv[a], g_scenarios[i].name)) {
+                break;
+            }
+        }
+        if (i == scenario_count) {
+            fprintf(stderr, "unknown scenario \"%s\"\n", argv[a]);
+            return EXIT_FAILURE;
+        }
+        run_scenario(g_scenarios + i, rounds);
+    }
+    return EXIT_SUCCESS;
+}
+
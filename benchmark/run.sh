@@ -0,0 +1,183 @@
+#!/usr/bin/env bash
+
+# runs herbstluftwm in a virtual X server and measures the latency of some
+# scripted scenarios. For each scenario one JSON object is printed per line:
+#
+#   {"scenario":"map","samples":400,"p50_usec":812,"p90_usec":1630,
+#    "p99_usec":2710,"max_usec":3020,"events":1210,"requests":9650,
+#    "server_usec":402210}
+#
+# The percentiles are measured on the client side, i.e. they include the IPC
+# or X round trip. events, requests and server_usec are read from the stats
+# object of herbstluftwm and cover all X events handled during the scenario.
+#
+# usage: run.sh [-n CLIENTS] [-r ROUNDS] [SCENARIO ...]
+
+herbstluftwm=${HERBSTLUFTWM:-./herbstluftwm}
+herbstclient=${HERBSTCLIENT:-./herbstclient}
+bench_clients=${BENCH_CLIENTS:-./benchmark/bench-clients}
+xserver=${BENCH_XSERVER:-Xvfb}
+clients=50
+rounds=100
+all_scenarios=( ipc map tag_switch split_remove load_deep drag )
+
+while getopts "n:r:" opt ; do
+    case "$opt" in
+        n) clients=$OPTARG ;;
+        r) rounds=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+scenarios=( "${@:-${all_scenarios[@]}}" )
+
+hc() { "$herbstclient" "$@" ;}
+
+now_usec() {
+    local t
+    t=$(date +%s%N)
+    echo $((t / 1000))
+}
+
+# runs hc with the given arguments and prints its duration
+timed_hc() {
+    local begin end
+    begin=$(now_usec)
+    hc "$@" > /dev/null
+    end=$(now_usec)
+    echo $((end - begin))
+}
+
+# reads latencies from stdin and prints the JSON line for scenario $1
+report() {
+    local name=$1 stats
+    stats=$(hc sprintf S "%s %s %s" \
+                stats.count stats.requests stats.total_usec echo S)
+    sort -n | awk -v name="$name" -v stats="$stats" '
+        function pct(p,   i) {
+            i = int((p * NR + 99) / 100)
+            return lat[i < 1 ? 1 : i]
+        }
+        { lat[NR] = $1 }
+        END {
+            split(stats, s, " ")
+            printf "{\"scenario\":\"%s\",\"samples\":%d", name, NR
+            if (NR > 0) {
+                printf ",\"p50_usec\":%d,\"p90_usec\":%d", pct(50), pct(90)
+                printf ",\"p99_usec\":%d,\"max_usec\":%d", pct(99), lat[NR]
+            }
+            printf ",\"events\":%d,\"requests\":%d,\"server_usec\":%d}\n", \
+                s[1], s[2], s[3]
+        }'
+}
+
+# starts bench-clients holding $1 windows on the focused tag
+hold_clients() {
+    local count=$1 expected
+    expected=$(( $(hc attr tags.focus.client_count) + count ))
+    "$bench_clients" hold "$count" > /dev/null &
+    held_pids+=( $! )
+    while [ "$(hc attr tags.focus.client_count)" -lt "$expected" ] ; do
+        sleep 0.05
+    done
+}
+
+release_clients() {
+    [ ${#held_pids[@]} -gt 0 ] && kill "${held_pids[@]}" 2> /dev/null
+    wait "${held_pids[@]}" 2> /dev/null
+    held_pids=( )
+    sleep 0.2
+}
+
+scenario_ipc() {
+    for ((i = 0; i < rounds; i++)) ; do
+        timed_hc true
+    done
+}
+
+scenario_map() {
+    "$bench_clients" map "$clients" $((rounds / 10 + 1))
+}
+
+scenario_tag_switch() {
+    hold_clients "$clients"
+    for ((i = 0; i < rounds; i++)) ; do
+        timed_hc use_index +1
+    done
+}
+
+scenario_split_remove() {
+    hold_clients "$clients"
+    for ((i = 0; i < rounds; i++)) ; do
+        timed_hc split explode
+        timed_hc split explode
+        timed_hc remove
+        timed_hc remove
+    done
+}
+
+# prints a layout with nested splits of the given depth
+deep_layout() {
+    local depth=$1
+    if [ "$depth" -le 0 ] ; then
+        echo -n "(clients vertical:0)"
+    else
+        echo -n "(split horizontal:0.5:1 (clients max:0) "
+        deep_layout $((depth - 1))
+        echo -n ")"
+    fi
+}
+
+scenario_load_deep() {
+    local layout
+    layout=$(deep_layout 12)
+    hold_clients "$clients"
+    for ((i = 0; i < rounds; i++)) ; do
+        timed_hc load "$layout"
+        timed_hc load "(clients vertical:0)"
+    done
+}
+
+scenario_drag() {
+    hc floating on
+    hc mousebind Mod4-Button1 move
+    "$bench_clients" drag "$rounds"
+    hc floating off
+}
+
+# find a free display
+display=1
+while [ -e "/tmp/.X11-unix/X$display" ] ; do
+    display=$((display + 1))
+done
+"$xserver" ":$display" -screen 0 1920x1080x24 -nolisten tcp > /dev/null 2>&1 &
+xserver_pid=$!
+while [ ! -e "/tmp/.X11-unix/X$display" ] ; do
+    sleep 0.1
+done
+export DISPLAY=":$display"
+
+"$herbstluftwm" --autostart /dev/null > /dev/null 2>&1 &
+hlwm_pid=$!
+until hc true 2> /dev/null ; do
+    sleep 0.1
+done
+hc add bench_other
+held_pids=( )
+latencies=$(mktemp)
+
+for scenario in "${scenarios[@]}" ; do
+    hc use_index 0
+    hc attr stats.reset true
+    # not in a pipe, such that hold_clients can remember the pids
+    "scenario_$scenario" > "$latencies"
+    report "$scenario" < "$latencies"
+    release_clients
+    hc load "(clients vertical:0)"
+done
+rm -f "$latencies"
+
+hc quit
+wait "$hlwm_pid"
+kill "$xserver_pid"
+wait "$xserver_pid" 2> /dev/null
@@ -8,11 +8,19 @@ PKG_CONFIG ?= pkg-config
 XINERAMALIBS = `$(PKG_CONFIG) --silence-errors --libs xinerama`
 XINERAMAFLAGS = `$(PKG_CONFIG) --exists xinerama && echo -DXINERAMA`
 
-INCS = -Isrc/ -I/usr/include -I${X11INC}  `$(PKG_CONFIG) --cflags glib-2.0`
-LIBS = -lc -L${X11LIB} -lXext -lX11 $(XINERAMALIBS) `$(PKG_CONFIG) --libs glib-2.0`
+# XRandR
+XRANDRLIBS = `$(PKG_CONFIG) --silence-errors --libs xrandr`
+XRANDRFLAGS = `$(PKG_CONFIG) --exists xrandr && echo -DXRANDR`
+
+INCS = -Isrc/ -I/usr/include -I${X11INC}  `$(PKG_CONFIG) --cflags glib-2.0 xcb x11-xcb`
+LIBS = -lc -L${X11LIB} -lXext -lX11 $(XINERAMALIBS) $(XRANDRLIBS) `$(PKG_CONFIG) --libs glib-2.0 xcb x11-xcb`
+
+# only for the synthetic clients of the benchmark
+BENCHLIBS = -L${X11LIB} -lX11 `$(PKG_CONFIG) --libs xtst`
 
 ifeq ($(shell uname),Linux)
 LIBS += -lrt
+BENCHLIBS += -lrt
 endif
 
 # FLAGS
@@ -29,7 +37,7 @@ VERSIONFLAGS = \
     -D HERBSTLUFT_VERSION_MINOR=$(VERSION_MINOR) \
     -D HERBSTLUFT_VERSION_PATCH=$(VERSION_PATCH)
 CPPFLAGS ?=
-CPPFLAGS += $(INCS) -D _XOPEN_SOURCE=600 $(VERSIONFLAGS) $(XINERAMAFLAGS)
+CPPFLAGS += $(INCS) -D _XOPEN_SOURCE=600 $(VERSIONFLAGS) $(XINERAMAFLAGS) $(XRANDRFLAGS)
 CPPFLAGS += -D HERBSTLUFT_GLOBAL_AUTOSTART=\"$(CONFIGDIR)/autostart\"
 LDFLAGS ?= -g
 DESTDIR ?=
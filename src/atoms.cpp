@@ -0,0 +1,83 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#include "atoms.h"
+#include "globals.h"
+#include "utils.h"
+#include "x11-utils.h"
+#include "ipc-protocol.h"
+#include "ewmh.h"
+
+#include "glib-backports.h"
+#include <stdio.h>
+
+static GHashTable* g_atoms; // atom name -> Atom
+
+// atoms that are needed anyway, they are interned at once on startup
+static const char* g_fixed_atom_names[] = {
+    "ATOM",
+    "UTF8_STRING",
+    "WM_DELETE_WINDOW",
+    "WM_PROTOCOLS",
+    "WM_STATE",
+    "WM_TAKE_FOCUS",
+    "WM_WINDOW_ROLE",
+    "_NET_WM_PID",
+    HERBST_IPC_ARGS_ATOM,
+    HERBST_IPC_OUTPUT_ATOM,
+    HERBST_IPC_STATUS_ATOM,
+    HERBST_HOOK_WIN_ID_ATOM,
+};
+
+void atoms_init() {
+    g_atoms = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    // collect the names of all fixed atoms ...
+    GArray* names = g_array_new(false, false, sizeof(char*));
+    for (int i = 0; i < LENGTH(g_fixed_atom_names); i++) {
+        char* name = g_strdup(g_fixed_atom_names[i]);
+        g_array_append_val(names, name);
+    }
+    for (int i = 0; i < NetCOUNT; i++) {
+        if (g_netatom_names[i]) {
+            char* name = g_strdup(g_netatom_names[i]);
+            g_array_append_val(names, name);
+        }
+    }
+    for (int i = 0; i < HERBST_HOOK_PROPERTY_COUNT; i++) {
+        char* name = g_strdup_printf(HERBST_HOOK_PROPERTY_FORMAT, i);
+        g_array_append_val(names, name);
+    }
+    // ... and intern them with a single round trip
+    Atom* atoms = g_new(Atom, names->len);
+    if (X11_ROUND_TRIP(XInternAtoms(g_display, (char**)names->data, names->len,
+                                    False, atoms))) {
+        for (int i = 0; i < names->len; i++) {
+            // the hash table takes the ownership of the name
+            g_hash_table_insert(g_atoms, g_array_index(names, char*, i),
+                                GUINT_TO_POINTER(atoms[i]));
+        }
+    } else {
+        for (int i = 0; i < names->len; i++) {
+            g_free(g_array_index(names, char*, i));
+        }
+    }
+    g_free(atoms);
+    g_array_free(names, true);
+}
+
+void atoms_destroy() {
+    g_hash_table_destroy(g_atoms);
+}
+
+Atom atom_get(const char* name) {
+    Atom atom = GPOINTER_TO_UINT(g_hash_table_lookup(g_atoms, name));
+    if (atom == None) {
+        atom = X11_ROUND_TRIP(XInternAtom(g_display, name, False));
+        if (atom != None) {
+            g_hash_table_insert(g_atoms, g_strdup(name), GUINT_TO_POINTER(atom));
+        }
+    }
+    return atom;
+}
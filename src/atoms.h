@@ -0,0 +1,19 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#ifndef __HERBSTLUFT_ATOMS_H_
+#define __HERBSTLUFT_ATOMS_H_
+
+#include <X11/Xlib.h>
+
+void atoms_init();
+void atoms_destroy();
+
+// returns the atom with the given name. Only names that were not seen
+// before cause a request to the X server.
+Atom atom_get(const char* name);
+
+#endif
+
@@ -9,6 +9,7 @@
 #include "layout.h"
 #include "stack.h"
 #include "utils.h"
+#include "x11-utils.h"
 #include "hook.h"
 #include "mouse.h"
 #include "ewmh.h"
@@ -18,6 +19,8 @@
 #include "decoration.h"
 #include "key.h"
 #include "desktopwindow.h"
+#include "state.h"
+#include "stats.h"
 // system
 #include "glib-backports.h"
 #include <assert.h>
@@ -32,6 +35,7 @@
 #include <X11/Xproto.h>
 #include <X11/Xutil.h>
 #include <X11/Xatom.h>
+#include <X11/Xlib-xcb.h>
 
 static int g_monitor_float_treshold = 24;
 
@@ -40,6 +44,16 @@ static int* g_snap_gap;
 
 static GHashTable* g_clients; // container of all clients
 static HSObject*   g_client_object;
+static int         g_visibility_batch = 0; // nesting depth
+static GArray*     g_visibility_queue; // of HSClient*, see client_set_visible()
+// other windows, e.g. frame windows, queued by window_set_visible()
+typedef struct {
+    Window  window;
+    bool    visible;
+} HSWindowVisibility;
+static GArray*     g_window_visibility_queue; // of HSWindowVisibility
+static GArray*     g_title_queue; // of HSClient*, see client_title_changed()
+static int*        g_title_update_interval;
 
 // atoms from dwm.c
 // default atoms
@@ -73,22 +87,28 @@ static HSClient* create_client() {
 }
 
 static void fetch_colors() {
-    g_window_gap = &(settings_find("window_gap")->value.i);
-    g_snap_gap = &(settings_find("snap_gap")->value.i);
-    g_raise_on_focus = &(settings_find("raise_on_focus")->value.i);
+    g_window_gap = &(settings_by_id(SETTING_WINDOW_GAP)->value.i);
+    g_snap_gap = &(settings_by_id(SETTING_SNAP_GAP)->value.i);
+    g_raise_on_focus = &(settings_by_id(SETTING_RAISE_ON_FOCUS)->value.i);
 }
 
 void clientlist_init() {
     // init regex simple..
     fetch_colors();
-    g_wmatom[WMProtocols] = XInternAtom(g_display, "WM_PROTOCOLS", False);
-    g_wmatom[WMDelete] = XInternAtom(g_display, "WM_DELETE_WINDOW", False);
-    g_wmatom[WMState] = XInternAtom(g_display, "WM_STATE", False);
-    g_wmatom[WMTakeFocus] = XInternAtom(g_display, "WM_TAKE_FOCUS", False);
+    g_wmatom[WMProtocols] = ATOM("WM_PROTOCOLS");
+    g_wmatom[WMDelete] = ATOM("WM_DELETE_WINDOW");
+    g_wmatom[WMState] = ATOM("WM_STATE");
+    g_wmatom[WMTakeFocus] = ATOM("WM_TAKE_FOCUS");
     // init actual client list
     g_client_object = hsobject_create_and_link(hsobject_root(), "clients");
     g_clients = g_hash_table_new_full(g_int_hash, g_int_equal,
                                       NULL, (GDestroyNotify)client_destroy);
+    g_visibility_queue = g_array_new(false, false, sizeof(HSClient*));
+    g_window_visibility_queue = g_array_new(false, false,
+                                            sizeof(HSWindowVisibility));
+    g_title_queue = g_array_new(false, false, sizeof(HSClient*));
+    g_title_update_interval =
+        &(settings_by_id(SETTING_TITLE_UPDATE_INTERVAL)->value.i);
 }
 
 void clientlist_end_startup() {
@@ -138,6 +158,9 @@ void clientlist_destroy() {
     g_hash_table_foreach(g_clients, client_show_window, NULL);
 
     g_hash_table_destroy(g_clients);
+    g_array_free(g_visibility_queue, true);
+    g_array_free(g_window_visibility_queue, true);
+    g_array_free(g_title_queue, true);
     hsobject_unlink_and_destroy(hsobject_root(), g_client_object);
 }
 
@@ -212,15 +235,153 @@ static GString* client_attr_sh_floating(HSAttribute* attr) {
     return NULL;
 }
 
-HSClient* manage_client(Window win, bool force_unmanage) {
-    if (is_herbstluft_window(g_display, win)) {
+// the maximum length of the properties in HSWindowInfo, in 32 bit units
+#define WINDOW_INFO_PROPERTY_LENGTH 4096
+
+// converts the reply of a text property like XGetTextProperty() and
+// window_property_to_g_string() do. Returns NULL if the property is not set
+static GString* text_property_reply_to_g_string(xcb_get_property_reply_t* reply) {
+    if (!reply || reply->type == XCB_NONE) {
+        return NULL;
+    }
+    char* value = (char*)xcb_get_property_value(reply);
+    int len = xcb_get_property_value_length(reply);
+    if (reply->type == XA_STRING || reply->type == ATOM("UTF8_STRING")) {
+        return g_string_new_len(value, strnlen(value, len));
+    }
+    // other encodings are converted locally by Xlib
+    GString* result = NULL;
+    char** list = NULL;
+    int n = 0;
+    XTextProperty prop;
+    prop.value = (unsigned char*)value;
+    prop.encoding = reply->type;
+    prop.format = reply->format;
+    prop.nitems = reply->format ? len / (reply->format / 8) : 0;
+    if (XmbTextPropertyToTextList(g_display, &prop, &list, &n) >= Success
+        && n > 0 && *list)
+    {
+        result = g_string_new(*list);
+        XFreeStringList(list);
+    }
+    return result;
+}
+
+void window_info_fetch(const Window* wins, size_t count, HSWindowInfo* info) {
+    xcb_connection_t* conn = XGetXCBConnection(g_display);
+    xcb_get_geometry_cookie_t* geometry = g_new(xcb_get_geometry_cookie_t, count);
+    // the property requests of window i are at 4 * i, ..., 4 * i + 3
+    enum { PropPid, PropClass, PropType, PropRole, PropCount };
+    xcb_get_property_cookie_t* props =
+        g_new(xcb_get_property_cookie_t, PropCount * count);
+    for (size_t i = 0; i < count; i++) {
+        xcb_get_property_cookie_t* p = props + PropCount * i;
+        geometry[i] = xcb_get_geometry(conn, wins[i]);
+        p[PropPid] = xcb_get_property(conn, 0, wins[i], ATOM("_NET_WM_PID"),
+                                      XA_CARDINAL, 0, 1);
+        p[PropClass] = xcb_get_property(conn, 0, wins[i], XA_WM_CLASS,
+                                        XA_STRING, 0,
+                                        WINDOW_INFO_PROPERTY_LENGTH);
+        // only a few window types are expected, see ewmh_get_window_type()
+        p[PropType] = xcb_get_property(conn, 0, wins[i],
+                                       g_netatom[NetWmWindowType],
+                                       XA_ATOM, 0, 10);
+        p[PropRole] = xcb_get_property(conn, 0, wins[i],
+                                       ATOM("WM_WINDOW_ROLE"),
+                                       XCB_GET_PROPERTY_TYPE_ANY, 0,
+                                       WINDOW_INFO_PROPERTY_LENGTH);
+    }
+    // all requests are sent, so collecting the replies costs only a single
+    // round trip
+    for (size_t i = 0; i < count; i++) {
+        HSWindowInfo* in = info + i;
+        xcb_get_property_cookie_t* p = props + PropCount * i;
+        xcb_get_property_reply_t* reply[PropCount];
+        xcb_get_geometry_reply_t* geo =
+            xcb_get_geometry_reply(conn, geometry[i], NULL);
+        for (int j = 0; j < PropCount; j++) {
+            reply[j] = xcb_get_property_reply(conn, p[j], NULL);
+        }
+        in->geometry = geo
+            ? Rectangle(geo->x, geo->y, geo->width, geo->height)
+            : Rectangle(0, 0, 0, 0);
+        // the pid
+        xcb_get_property_reply_t* r = reply[PropPid];
+        in->pid = -1;
+        if (r && r->type == XA_CARDINAL && r->format == 32
+            && r->bytes_after == 0 && xcb_get_property_value_length(r) == 4) {
+            in->pid = *(int*)xcb_get_property_value(r);
+        }
+        // WM_CLASS consists of the instance and the class, each terminated
+        // by a null byte
+        r = reply[PropClass];
+        in->instance = g_string_new("");
+        in->window_class = g_string_new("");
+        if (r && r->type == XA_STRING && r->format == 8) {
+            char* value = (char*)xcb_get_property_value(r);
+            int len = xcb_get_property_value_length(r);
+            int inst_len = strnlen(value, len);
+            g_string_append_len(in->instance, value, inst_len);
+            if (inst_len + 1 < len) {
+                g_string_append_len(in->window_class, value + inst_len + 1,
+                    strnlen(value + inst_len + 1, len - inst_len - 1));
+            }
+        }
+        // the window type as in ewmh_get_window_type()
+        r = reply[PropType];
+        in->window_type = -1;
+        if (r && r->type == XA_ATOM && r->format == 32 && r->bytes_after == 0
+            && xcb_get_property_value_length(r) >= 4) {
+            Atom wintype = *(uint32_t*)xcb_get_property_value(r);
+            int index = ewmh_atom_index(wintype);
+            if (index >= NetWmWindowTypeFIRST && index <= NetWmWindowTypeLAST) {
+                in->window_type = index;
+            }
+        }
+        in->role = text_property_reply_to_g_string(reply[PropRole]);
+        free(geo);
+        for (int j = 0; j < PropCount; j++) {
+            free(reply[j]);
+        }
+    }
+    g_free(geometry);
+    g_free(props);
+}
+
+void window_info_free(HSWindowInfo* info) {
+    g_string_free(info->window_class, true);
+    g_string_free(info->instance, true);
+    if (info->role) {
+        g_string_free(info->role, true);
+    }
+}
+
+static HSClient* manage_client_with_info(Window win, bool force_unmanage,
+                                         const HSWindowInfo* info);
+
+HSClient* manage_client(Window win, bool force_unmanage,
+                        const HSWindowInfo* info) {
+    if (info) {
+        return manage_client_with_info(win, force_unmanage, info);
+    }
+    // fetch everything at once instead of one round trip per property
+    HSWindowInfo fetched;
+    window_info_fetch(&win, 1, &fetched);
+    HSClient* client = manage_client_with_info(win, force_unmanage, &fetched);
+    window_info_free(&fetched);
+    return client;
+}
+
+static HSClient* manage_client_with_info(Window win, bool force_unmanage,
+                                         const HSWindowInfo* info) {
+    if (!strcmp(info->window_class->str, HERBST_FRAME_CLASS)) {
         // ignore our own window
         return NULL;
     }
     if (get_client_from_window(win)) {
         return NULL;
     }
-    if (ewmh_is_desktop_window(win)) {
+    if (info->window_type == NetWmWindowTypeDesktop) {
         DesktopWindow::registerDesktop(win);
         monitor_restack(get_current_monitor());
         XMapWindow(g_display, win);
@@ -228,28 +389,20 @@ HSClient* manage_client(Window win, bool force_unmanage) {
     }
     // init client
     HSClient* client = create_client();
-    client->pid = window_pid(g_display, win);
+    client->pid = info->pid;
     HSMonitor* m = get_current_monitor();
     // set to window properties
     client->window = win;
     client_update_title(client);
 
-    unsigned int border, depth;
-    Window root_win;
-    int x, y;
-    unsigned int w, h;
-    XGetGeometry(g_display, win, &root_win, &x, &y, &w, &h, &border, &depth);
     // treat wanted coordinates as floating coords
-    client->float_size.x = x;
-    client->float_size.y = y;
-    client->float_size.width = w;
-    client->float_size.height = h;
+    client->float_size = info->geometry;
     client->last_size = client->float_size;
 
     // apply rules
     HSClientChanges changes;
     client_changes_init(&changes, client);
-    rules_apply(client, &changes);
+    rules_apply(client, &changes, info);
     if (changes.tag_name) {
         client->tag = find_tag(changes.tag_name->str);
     }
@@ -320,6 +473,7 @@ HSClient* manage_client(Window win, bool force_unmanage) {
         ATTRIBUTE_BOOL(     "sizehints_tiling",   client->sizehints_tiling, client_attr_sh_tiling),
         ATTRIBUTE_BOOL(     "sizehints_floating", client->sizehints_floating, client_attr_sh_floating),
         ATTRIBUTE_BOOL(     "urgent",       client->urgent,         client_attr_urgent),
+        ATTRIBUTE_UINT(     "generation",   client->generation,     ATTR_READ_ONLY),
         ATTRIBUTE_LAST,
     };
     hsobject_set_attributes(&client->object, attributes);
@@ -338,6 +492,7 @@ HSClient* manage_client(Window win, bool force_unmanage) {
     XChangeSaveSet(g_display, client->window, SetModeInsert);
     XReparentWindow(g_display, client->window, client->dec.decwin, 40, 40);
     if (g_startup) client->ignore_unmaps++;
+    client_update_container(client);
     // get events from window
     XSelectInput(g_display, client->dec.decwin, (EnterWindowMask | LeaveWindowMask |
                             ButtonPressMask | ButtonReleaseMask |
@@ -414,6 +569,22 @@ void client_destroy(HSClient* client) {
     if (lastfocus == client) {
         lastfocus = NULL;
     }
+    if (client->visibility_queued) {
+        for (int i = 0; i < g_visibility_queue->len; i++) {
+            if (g_array_index(g_visibility_queue, HSClient*, i) == client) {
+                g_array_remove_index(g_visibility_queue, i);
+                break;
+            }
+        }
+    }
+    if (client->title_queued) {
+        for (int i = 0; i < g_title_queue->len; i++) {
+            if (g_array_index(g_title_queue, HSClient*, i) == client) {
+                g_array_remove_index(g_title_queue, i);
+                break;
+            }
+        }
+    }
     if (client->tag && client->slice) {
         stack_remove_slice(client->tag->stack, client->slice);
     }
@@ -584,53 +755,11 @@ void client_resize_tiling(HSClient* client, Rectangle rect, HSFrame* frame) {
     decoration_resize_outline(client, rect, scheme);
 }
 
-// from dwm.c
 bool applysizehints(HSClient *c, int *w, int *h) {
-    bool baseismin;
-
-    /* set minimum possible */
-    *w = MAX(1, *w);
-    *h = MAX(1, *h);
-    if(*h < WINDOW_MIN_HEIGHT)
-        *h = WINDOW_MIN_HEIGHT;
-    if(*w < WINDOW_MIN_WIDTH)
-        *w = WINDOW_MIN_WIDTH;
     bool sizehints = (is_client_floated(c) || c->pseudotile)
                         ? c->sizehints_floating
                         : c->sizehints_tiling;
-    if(sizehints) {
-        /* see last two sentences in ICCCM 4.1.2.3 */
-        baseismin = c->basew == c->minw && c->baseh == c->minh;
-        if(!baseismin) { /* temporarily remove base dimensions */
-            *w -= c->basew;
-            *h -= c->baseh;
-        }
-        /* adjust for aspect limits */
-        if(c->mina > 0 && c->maxa > 0) {
-            if(c->maxa < (float)*w / *h)
-                *w = *h * c->maxa + 0.5;
-            else if(c->mina < (float)*h / *w)
-                *h = *w * c->mina + 0.5;
-        }
-        if(baseismin) { /* increment calculation requires this */
-            *w -= c->basew;
-            *h -= c->baseh;
-        }
-        /* adjust for increment value */
-        if(c->incw)
-            *w -= *w % c->incw;
-        if(c->inch)
-            *h -= *h % c->inch;
-        /* restore base dimensions */
-        *w += c->basew;
-        *h += c->baseh;
-        *w = MAX(*w, c->minw);
-        *h = MAX(*h, c->minh);
-        if(c->maxw)
-            *w = MIN(*w, c->maxw);
-        if(c->maxh)
-            *h = MIN(*h, c->maxh);
-    }
+    size_hints_apply(sizehints ? &c->size_hints : NULL, w, h);
     return *w != c->last_size.width || *h != c->last_size.height;
 }
 
@@ -644,49 +773,49 @@ void updatesizehints(HSClient *c) {
     long msize;
     XSizeHints size;
 
-    if(!XGetWMNormalHints(g_display, c->window, &size, &msize))
+    if(!X11_ROUND_TRIP(XGetWMNormalHints(g_display, c->window, &size, &msize)))
         /* size is uninitialized, ensure that size.flags aren't used */
         size.flags = PSize;
     if(size.flags & PBaseSize) {
-        c->basew = size.base_width;
-        c->baseh = size.base_height;
+        c->size_hints.basew = size.base_width;
+        c->size_hints.baseh = size.base_height;
     }
     else if(size.flags & PMinSize) {
-        c->basew = size.min_width;
-        c->baseh = size.min_height;
+        c->size_hints.basew = size.min_width;
+        c->size_hints.baseh = size.min_height;
     } else {
-        c->basew = c->baseh = 0;
+        c->size_hints.basew = c->size_hints.baseh = 0;
     }
     if(size.flags & PResizeInc) {
-        c->incw = size.width_inc;
-        c->inch = size.height_inc;
+        c->size_hints.incw = size.width_inc;
+        c->size_hints.inch = size.height_inc;
     }
     else
-        c->incw = c->inch = 0;
+        c->size_hints.incw = c->size_hints.inch = 0;
     if(size.flags & PMaxSize) {
-        c->maxw = size.max_width;
-        c->maxh = size.max_height;
+        c->size_hints.maxw = size.max_width;
+        c->size_hints.maxh = size.max_height;
     } else {
-        c->maxw = c->maxh = 0;
+        c->size_hints.maxw = c->size_hints.maxh = 0;
     }
     if(size.flags & PMinSize) {
-        c->minw = size.min_width;
-        c->minh = size.min_height;
+        c->size_hints.minw = size.min_width;
+        c->size_hints.minh = size.min_height;
     }
     else if(size.flags & PBaseSize) {
-        c->minw = size.base_width;
-        c->minh = size.base_height;
+        c->size_hints.minw = size.base_width;
+        c->size_hints.minh = size.base_height;
     } else {
-        c->minw = c->minh = 0;
+        c->size_hints.minw = c->size_hints.minh = 0;
     }
     if(size.flags & PAspect) {
-        c->mina = (float)size.min_aspect.y / size.min_aspect.x;
-        c->maxa = (float)size.max_aspect.x / size.max_aspect.y;
+        c->size_hints.mina = (float)size.min_aspect.y / size.min_aspect.x;
+        c->size_hints.maxa = (float)size.max_aspect.x / size.max_aspect.y;
     } else {
-        c->maxa = c->mina = 0.0;
+        c->size_hints.maxa = c->size_hints.mina = 0.0;
     }
-    //c->isfixed = (c->maxw && c->minw && c->maxh && c->minh
-    //             && c->maxw == c->minw && c->maxh == c->minh);
+    //c->isfixed = (c->size_hints.maxw && c->size_hints.minw && c->size_hints.maxh && c->size_hints.minh
+    //             && c->size_hints.maxw == c->size_hints.minw && c->size_hints.maxh == c->size_hints.minh);
 }
 
 
@@ -761,32 +890,40 @@ void window_close(Window window) {
     XSendEvent(g_display, window, False, NoEventMask, &ev);
 }
 
-void window_set_visible(Window win, bool visible) {
+// maps or unmaps win without generating events for the window manager. The
+// server has to be grabbed and the SubstructureNotifyMask of the root window
+// has to be removed by the caller
+static void window_set_visible_grabbed(Window win, bool visible) {
     static int (*action[])(Display*,Window) = {
         XUnmapWindow,
         XMapWindow,
     };
     unsigned long event_mask = CLIENT_EVENT_MASK;
-    XGrabServer(g_display);
     XSelectInput(g_display, win, event_mask & ~StructureNotifyMask);
-    XSelectInput(g_display, g_root, ROOT_EVENT_MASK & ~SubstructureNotifyMask);
     action[visible](g_display, win);
     XSelectInput(g_display, win, event_mask);
+}
+
+void window_set_visible(Window win, bool visible) {
+    if (g_visibility_batch > 0) {
+        HSWindowVisibility entry = { win, visible };
+        g_array_append_val(g_window_visibility_queue, entry);
+        return;
+    }
+    XGrabServer(g_display);
+    XSelectInput(g_display, g_root, ROOT_EVENT_MASK & ~SubstructureNotifyMask);
+    window_set_visible_grabbed(win, visible);
     XSelectInput(g_display, g_root, ROOT_EVENT_MASK);
     XUngrabServer(g_display);
 }
 
-void client_set_visible(HSClient* client, bool visible) {
-    if (visible == client->visible) return;
-    if (visible) {
-        /* Grab the server to make sure that the frame window is mapped before
-           the client gets its MapNotify, i.e. to make sure the client is
-           _visible_ when it gets MapNotify. */
-        XGrabServer(g_display);
+// sends the requests that make the windows of client match client->visible
+static void client_update_window_visibility(HSClient* client) {
+    client->mapped = client->visible;
+    if (client->visible) {
         window_update_wm_state(client->window, WmStateNormalState);
         XMapWindow(g_display, client->window);
         XMapWindow(g_display, client->dec.decwin);
-        XUngrabServer(g_display);
     } else {
         /* we unmap the client itself so that we can get MapRequest
            events, and because the ICCCM tells us to! */
@@ -795,7 +932,85 @@ void client_set_visible(HSClient* client, bool visible) {
         window_update_wm_state(client->window, WmStateWithdrawnState);
         client->ignore_unmaps++;
     }
+}
+
+void client_set_visible(HSClient* client, bool visible) {
+    if (visible == client->visible) return;
     client->visible = visible;
+    if (client->mapped && client->dec.parent != g_root) {
+        // the windows stay mapped and the container of the tag is mapped or
+        // unmapped instead, see tag_container_set_visible()
+        window_update_wm_state(client->window,
+            visible ? WmStateNormalState : WmStateIconicState);
+        return;
+    }
+    if (g_visibility_batch > 0) {
+        // if the client is queued already, then it is changed back to the
+        // state the X server knows, so nothing needs to be sent
+        client->visibility_queued = !client->visibility_queued;
+        if (client->visibility_queued) {
+            g_array_append_val(g_visibility_queue, client);
+        }
+        return;
+    }
+    if (visible) {
+        /* Grab the server to make sure that the frame window is mapped before
+           the client gets its MapNotify, i.e. to make sure the client is
+           _visible_ when it gets MapNotify. */
+        XGrabServer(g_display);
+        client_update_window_visibility(client);
+        XUngrabServer(g_display);
+    } else {
+        client_update_window_visibility(client);
+    }
+}
+
+void client_update_container(HSClient* client) {
+    Window parent = tag_window_parent(client->tag);
+    if (client->dec.parent == parent) {
+        return;
+    }
+    Rectangle rect = client->dec.last_outer_rect;
+    XReparentWindow(g_display, client->dec.decwin, parent, rect.x, rect.y);
+    client->dec.parent = parent;
+    if (parent == g_root && client->mapped && !client->visible) {
+        // without a container, hidden clients need to be unmapped
+        client_update_window_visibility(client);
+    }
+}
+
+void client_visibility_begin() {
+    g_visibility_batch++;
+}
+
+void client_visibility_end() {
+    g_visibility_batch--;
+    if (g_visibility_batch > 0 || (g_visibility_queue->len == 0
+                                   && g_window_visibility_queue->len == 0)) {
+        return;
+    }
+    XGrabServer(g_display);
+    if (g_window_visibility_queue->len > 0) {
+        XSelectInput(g_display, g_root,
+                     ROOT_EVENT_MASK & ~SubstructureNotifyMask);
+        for (int i = 0; i < g_window_visibility_queue->len; i++) {
+            HSWindowVisibility* entry =
+                &g_array_index(g_window_visibility_queue, HSWindowVisibility, i);
+            window_set_visible_grabbed(entry->window, entry->visible);
+        }
+        XSelectInput(g_display, g_root, ROOT_EVENT_MASK);
+        g_array_set_size(g_window_visibility_queue, 0);
+    }
+    for (int i = 0; i < g_visibility_queue->len; i++) {
+        HSClient* client = g_array_index(g_visibility_queue, HSClient*, i);
+        // a client may be queued twice if it was changed back and forth
+        if (client->visibility_queued) {
+            client->visibility_queued = false;
+            client_update_window_visibility(client);
+        }
+    }
+    XUngrabServer(g_display);
+    g_array_set_size(g_visibility_queue, 0);
 }
 
 // heavily inspired by dwm.c
@@ -812,12 +1027,16 @@ static void client_set_urgent_force(HSClient* client, bool state) {
     snprintf(winid_str, STRING_BUF_SIZE, "0x%lx", client->window);
     hook_emit_list("urgent", state ? "on" : "off", winid_str, NULL);
 
+    if (client->urgent != state) {
+        client->tag->urgent_count += state ? 1 : -1;
+    }
     client->urgent = state;
+    state_client_changed(client);
 
     client_setup_border(client, client == frame_focused_client(g_cur_frame));
 
     XWMHints *wmh;
-    if(!(wmh = XGetWMHints(g_display, client->window)))
+    if(!(wmh = X11_ROUND_TRIP(XGetWMHints(g_display, client->window))))
         return;
 
     if (state) {
@@ -834,7 +1053,7 @@ static void client_set_urgent_force(HSClient* client, bool state) {
 
 // heavily inspired by dwm.c
 void client_update_wm_hints(HSClient* client) {
-    XWMHints* wmh = XGetWMHints(g_display, client->window);
+    XWMHints* wmh = X11_ROUND_TRIP(XGetWMHints(g_display, client->window));
     if (!wmh) {
         return;
     }
@@ -849,6 +1068,8 @@ void client_update_wm_hints(HSClient* client) {
         bool newval = (wmh->flags & XUrgencyHint) ? true : false;
         if (newval != client->urgent) {
             client->urgent = newval;
+            client->tag->urgent_count += newval ? 1 : -1;
+            state_client_changed(client);
             char winid_str[STRING_BUF_SIZE];
             snprintf(winid_str, STRING_BUF_SIZE, "0x%lx", client->window);
             client_setup_border(client, focused_client == client);
@@ -872,7 +1093,7 @@ void client_update_title(HSClient* client) {
         XTextProperty xtp_new_name;
         int len;
         char **return_list = NULL;
-        if (0 != XGetWMName(g_display, client->window, &xtp_new_name) &&
+        if (0 != X11_ROUND_TRIP(XGetWMName(g_display, client->window, &xtp_new_name)) &&
             0 == Xutf8TextPropertyToTextList(g_display, &xtp_new_name,
                                              &return_list, &len) && (len >= 1)){
             new_name = g_string_new(return_list[0]);
@@ -888,9 +1109,13 @@ void client_update_title(HSClient* client) {
             XFree(xtp_new_name.value);
         }
     }
+    client->title_update_usec = get_monotonic_usec();
     bool changed = (0 != strcmp(client->title->str, new_name->str));
     g_string_free(client->title, true);
     client->title = new_name;
+    if (changed) {
+        state_client_changed(client);
+    }
     if (changed && get_current_client() == client) {
         char buf[STRING_BUF_SIZE];
         snprintf(buf, STRING_BUF_SIZE, "0x%lx", client->window);
@@ -898,6 +1123,51 @@ void client_update_title(HSClient* client) {
     }
 }
 
+void client_title_changed(HSClient* client) {
+    if (client->title_queued) {
+        // it is read later anyway
+        stats_title_update_suppressed();
+        return;
+    }
+    client->title_queued = true;
+    g_array_append_val(g_title_queue, client);
+}
+
+// returns when the title of client may be read again
+static gint64 client_title_due(HSClient* client) {
+    return client->title_update_usec + MAX(0, *g_title_update_interval) * 1000;
+}
+
+void clientlist_flush_titles() {
+    if (g_title_queue->len == 0) {
+        return;
+    }
+    gint64 now = get_monotonic_usec();
+    // the clients that are not due yet stay in the queue
+    int kept = 0;
+    for (int i = 0; i < g_title_queue->len; i++) {
+        HSClient* client = g_array_index(g_title_queue, HSClient*, i);
+        if (client_title_due(client) > now) {
+            g_array_index(g_title_queue, HSClient*, kept++) = client;
+            continue;
+        }
+        client->title_queued = false;
+        client_update_title(client);
+    }
+    g_array_set_size(g_title_queue, kept);
+}
+
+gint64 clientlist_title_timeout() {
+    if (g_title_queue->len == 0) {
+        return -1;
+    }
+    gint64 due = G_MAXINT64;
+    for (int i = 0; i < g_title_queue->len; i++) {
+        due = MIN(due, client_title_due(g_array_index(g_title_queue, HSClient*, i)));
+    }
+    return MAX(0, due - get_monotonic_usec());
+}
+
 HSClient* get_current_client() {
     return frame_focused_client(g_cur_frame);
 }
@@ -905,6 +1175,7 @@ HSClient* get_current_client() {
 void client_set_fullscreen(HSClient* client, bool state) {
     if (client->fullscreen == state) return;
     client->fullscreen = state;
+    state_client_changed(client);
     if (client->ewmhnotify) {
         client->ewmhfullscreen = state;
     }
@@ -925,6 +1196,7 @@ void client_set_fullscreen(HSClient* client, bool state) {
 
 void client_set_pseudotile(HSClient* client, bool state) {
     client->pseudotile = state;
+    state_client_changed(client);
     monitor_apply_layout(find_monitor_with_tag(client->tag));
 }
 
@@ -1023,7 +1295,7 @@ bool client_sendevent(HSClient *client, Atom proto) {
     bool exists = false;
     XEvent ev;
 
-    if (XGetWMProtocols(g_display, client->window, &protocols, &n)) {
+    if (X11_ROUND_TRIP(XGetWMProtocols(g_display, client->window, &protocols, &n))) {
         while (!exists && n--)
             exists = protocols[n] == proto;
         XFree(protocols);
@@ -1094,7 +1366,7 @@ void client_fuzzy_fix_initial_position(HSClient* client) {
         } else { // neither of the corners is on some monitor
             // then use the screen edges as the reference
             XWindowAttributes attributes;
-            XGetWindowAttributes(g_display, g_root, &attributes);
+            X11_ROUND_TRIP(XGetWindowAttributes(g_display, g_root, &attributes));
             ref.x = 0;
             ref.y = 0;
             ref.width = attributes.width;
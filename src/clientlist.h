@@ -43,9 +43,12 @@ typedef struct HSClient {
                                 // action, because reparenting creates an unmap
                                 // notify event
     bool        visible;
-    // for size hints
-	float mina, maxa;
-    int basew, baseh, incw, inch, maxw, maxh, minw, minh;
+    bool        visibility_queued; // visible has not been sent to X yet
+    bool        mapped; // whether the windows are mapped
+    bool        title_queued; // the title has changed but is not read yet
+    gint64      title_update_usec; // when the title was read the last time
+    unsigned int generation; // global generation of the last change
+    HSSizeHints size_hints;
     // for other modules
     HSObject    object;
     struct HSSlice* slice;
@@ -69,8 +72,25 @@ void client_window_unfocus_last();
 void reset_client_colors();
 void reset_client_settings();
 
-// adds a new client to list of managed client windows
-HSClient* manage_client(Window win, bool force_unmanage = false);
+// what manage_client() and the rules need to know about a window
+typedef struct HSWindowInfo {
+    Rectangle   geometry;
+    int         pid;            // -1 if not set
+    GString*    window_class;
+    GString*    instance;
+    int         window_type;    // element of the NetWm-Enum or -1
+    GString*    role;           // NULL if not set
+} HSWindowInfo;
+
+// fetches the info of count windows with a single round trip. Each info has
+// to be freed with window_info_free()
+void window_info_fetch(const Window* wins, size_t count, HSWindowInfo* info);
+void window_info_free(HSWindowInfo* info);
+
+// adds a new client to list of managed client windows. If info is not given,
+// it is fetched first
+HSClient* manage_client(Window win, bool force_unmanage = false,
+                        const HSWindowInfo* info = NULL);
 void client_fuzzy_fix_initial_position(HSClient* client);
 void unmanage_client(Window win);
 
@@ -94,6 +114,15 @@ bool client_needs_minimal_dec(HSClient* client, HSFrame* frame);
 void client_set_urgent(HSClient* client, bool state);
 void client_update_wm_hints(HSClient* client);
 void client_update_title(HSClient* client);
+// schedules client_update_title(). All changes of a client's title within
+// one batch of events are read at once, and at most every
+// title_update_interval milliseconds.
+void client_title_changed(HSClient* client);
+// reads the titles that are due
+void clientlist_flush_titles();
+// returns the microseconds until the next queued title is due, or -1 if there
+// is none
+gint64 clientlist_title_timeout();
 void client_raise(HSClient* client);
 int close_command(int argc, char** argv, GString* output);
 void window_close(Window window);
@@ -115,6 +144,13 @@ bool is_window_class_ignored(char* window_class);
 bool is_window_ignored(Window win);
 
 void client_set_visible(HSClient* client, bool visible);
+// between client_visibility_begin() and client_visibility_end(),
+// client_set_visible() and window_set_visible() only queue the windows. They
+// are mapped and unmapped at the end within a single server grab.
+void client_visibility_begin();
+void client_visibility_end();
+// moves the decoration window into the container of the client's tag
+void client_update_container(HSClient* client);
 void window_set_visible(Window win, bool visible);
 
 unsigned long get_window_border_color(HSClient* client);
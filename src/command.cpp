@@ -14,6 +14,10 @@
 #include "rules.h"
 #include "object.h"
 #include "mouse.h"
+#include "trie.h"
+#include "hook.h"
+#include "ewmh.h"
+#include "stats.h"
 
 #include "glib-backports.h"
 #include <string.h>
@@ -32,6 +36,7 @@ static const char* completion_directions[]    = { "left", "right", "down", "up",
 static const char* completion_focus_args[]    = { "-i", "-e", NULL };
 static const char* completion_unrule_flags[]   = { "-F", "--all", NULL };
 static const char* completion_keyunbind_args[]= { "-F", "--all", NULL };
+static const char* completion_dump_state_args[]= { "--since", NULL };
 static const char* completion_flag_args[]     = { "on", "off", "true", "false", "toggle", NULL };
 static const char* completion_userattribute_types[] = { "int", "uint", "string", "bool", "color", NULL };
 static const char* completion_status[]        = { "status", NULL };
@@ -76,6 +81,7 @@ struct {
     { "true",           1,  no_completion },
     { "false",          1,  no_completion },
     { "!",              2,  parameter_expected_offset_1 },
+    { "batch",          2,  parameter_expected_offset_1 },
     { "try",            2,  parameter_expected_offset_1 },
     { "silent",         2,  parameter_expected_offset_1 },
     { "version",        1,  no_completion },
@@ -111,6 +117,8 @@ struct {
     { "shift",          2,  first_parameter_is_flag },
     { "remove",         1,  no_completion },
     { "rotate",         1,  no_completion },
+    { "undo",           1,  no_completion },
+    { "redo",           1,  no_completion },
     { "set",            3,  no_completion },
     { "get",            2,  no_completion },
     { "toggle",         2,  no_completion },
@@ -141,6 +149,8 @@ struct {
     { "load",           3,  no_completion },
     { "load",           2,  first_parameter_is_tag },
     { "tag_status",     2,  no_completion },
+    { "dump_state",     3,  no_completion },
+    { "profile",        1,  no_completion },
     { "floating",       3,  no_completion },
     { "floating",       2,  first_parameter_is_tag },
     { "unrule",         2,  no_completion },
@@ -194,6 +204,7 @@ struct {
     { "cycle_all",      EQ, 2,  NULL, completion_pm_one },
     { "cycle_monitor",  EQ, 1,  NULL, completion_pm_one },
     { "dump",           EQ, 1,  complete_against_tags, 0 },
+    { "dump_state",     EQ, 1,  NULL, completion_dump_state_args },
     { "detect_monitors", GE, 1,  NULL, completion_detect_monitors_args },
     { "floating",       EQ, 1,  complete_against_tags, 0 },
     { "floating",       EQ, 1,  NULL, completion_flag_args },
@@ -210,8 +221,11 @@ struct {
     { "merge_tag",      EQ, 2,  complete_merge_tag, 0 },
     { "move",           EQ, 1,  complete_against_tags, 0 },
     { "move_index",     EQ, 2,  NULL, completion_use_index_args },
+    { "move_windows",   EQ, 1,  complete_against_tags, 0 },
+    { "move_windows",   GE, 2,  rule_complete, 0 },
     { "or",             GE, 1,  complete_chain, 0 },
     { "!",              GE, 1,  complete_against_commands_1, 0 },
+    { "batch",          GE, 1,  complete_against_commands_1, 0 },
     { "try",            GE, 1,  complete_against_commands_1, 0 },
     { "silent",         GE, 1,  complete_against_commands_1, 0 },
     { "pseudotile",     EQ, 1,  NULL, completion_flag_args },
@@ -233,6 +247,7 @@ struct {
     { "shift",          EQ, 1,  NULL, completion_focus_args },
     { "shift",          EQ, 2,  NULL, completion_directions },
     { "set",            EQ, 1,  complete_against_settings, 0 },
+    { "set_many",       GE, 1,  complete_against_setting_names, 0 },
     { "split",          EQ, 1,  NULL, completion_split_modes },
     { "split",          EQ, 2,  NULL, completion_split_ratios },
     { "get",            EQ, 1,  complete_against_settings, 0 },
@@ -291,32 +306,72 @@ struct {
     { 0 },
 };
 
+// lookup tables for the static tables above, built once in command_init()
+static HSTrie* g_command_trie;  // command name -> CommandBinding*
+static HSTrie* g_parameter_expected_trie; // command name -> GArray of indices
+static HSTrie* g_completions_trie;        // command name -> GArray of indices
+
+static void index_table_insert(HSTrie* trie, const char* command, int index) {
+    GArray* indices = (GArray*)trie_lookup(trie, command);
+    if (!indices) {
+        indices = g_array_new(false, false, sizeof(int));
+        trie_insert(trie, command, indices);
+    }
+    g_array_append_val(indices, index);
+}
+
+static void index_table_free_entry(const char* key, void* data, void* user_data) {
+    g_array_free((GArray*)data, true);
+}
+
+void command_init() {
+    g_command_trie = trie_create();
+    for (int i = 0; g_commands[i].cmd.standard != NULL; i++) {
+        trie_insert(g_command_trie, g_commands[i].name, g_commands + i);
+    }
+    g_parameter_expected_trie = trie_create();
+    for (int i = 0; i < LENGTH(g_parameter_expected)
+                    && g_parameter_expected[i].command; i++) {
+        index_table_insert(g_parameter_expected_trie,
+                           g_parameter_expected[i].command, i);
+    }
+    g_completions_trie = trie_create();
+    for (int i = 0; i < LENGTH(g_completions)
+                    && g_completions[i].command; i++) {
+        index_table_insert(g_completions_trie, g_completions[i].command, i);
+    }
+}
+
+void command_destroy() {
+    trie_foreach_prefix(g_parameter_expected_trie, "",
+                        index_table_free_entry, NULL);
+    trie_foreach_prefix(g_completions_trie, "",
+                        index_table_free_entry, NULL);
+    trie_destroy(g_command_trie);
+    trie_destroy(g_parameter_expected_trie);
+    trie_destroy(g_completions_trie);
+}
+
 int call_command(int argc, char** argv, GString* output) {
     if (argc <= 0) {
         return HERBST_COMMAND_NOT_FOUND;
     }
-    int i = 0;
-    CommandBinding* bind = NULL;
-    while (g_commands[i].cmd.standard != NULL) {
-        if (!strcmp(g_commands[i].name, argv[0])) {
-            // if command was found
-            bind = g_commands + i;
-            break;
-        }
-        i++;
-    }
+    CommandBinding* bind = (CommandBinding*)trie_lookup(g_command_trie, argv[0]);
     if (!bind) {
         g_string_append_printf(output,
             "error: Command \"%s\" not found\n", argv[0]);
         return HERBST_COMMAND_NOT_FOUND;
     }
     int status;
+    HSStatsMeasure measure;
+    stats_command_begin(&measure);
     // TODO why isn't the cast (char** -> const char**) done automtically?
     if (bind->has_output) {
         status = bind->cmd.standard(argc, (const char**)argv, output);
     } else {
         status = bind->cmd.no_output(argc, (const char**)argv);
     }
+    stats_command_end(&measure, bind->name, argc, argv);
     return status;
 }
 
@@ -420,6 +475,22 @@ void try_complete_prefix_partial(const char* needle, const char* to_check,
     try_complete_suffix(needle, to_check, "\n", prefix, output);
 }
 
+struct HSTrieCompletion {
+    const char* needle;
+    GString*    output;
+};
+
+static void complete_against_trie_helper(const char* key, void* data,
+                                         void* user_data) {
+    struct HSTrieCompletion* c = (struct HSTrieCompletion*) user_data;
+    try_complete(c->needle, key, c->output);
+}
+
+void complete_against_trie(const char* needle, HSTrie* trie, GString* output) {
+    struct HSTrieCompletion data = { needle, output };
+    trie_foreach_prefix(trie, needle, complete_against_trie_helper, &data);
+}
+
 void complete_against_list(const char* needle, const char** list, GString* output) {
     while (*list) {
         const char* name = *list;
@@ -435,10 +506,7 @@ void complete_against_tags(int argc, char** argv, int pos, GString* output) {
     } else {
         needle = argv[pos];
     }
-    for (int i = 0; i < tag_get_count(); i++) {
-        char* name = get_tag_by_index(i)->name->str;
-        try_complete(needle, name, output);
-    }
+    complete_against_trie(needle, tag_name_trie(), output);
 }
 
 void complete_against_monitors(int argc, char** argv, int pos, GString* output) {
@@ -457,13 +525,10 @@ void complete_against_monitors(int argc, char** argv, int pos, GString* output)
         // complete against the absolute index
         g_string_printf(index_str, "%d", i);
         try_complete(needle, index_str->str, output);
-        // complete against the name
-        GString* name = monitor_with_index(i)->name;
-        if (name != NULL) {
-            try_complete(needle, name->str, output);
-        }
     }
     g_string_free(index_str, true);
+    // complete against the names
+    complete_against_trie(needle, monitor_name_trie(), output);
 }
 
 void complete_against_objects(int argc, char** argv, int pos, GString* output) {
@@ -613,6 +678,13 @@ void complete_merge_tag(int argc, char** argv, int pos, GString* output) {
     }
 }
 
+static void complete_against_int_settings_helper(const char* key, void* data,
+                                                void* user_data) {
+    if (((SettingsPair*)data)->type == HS_Int) {
+        complete_against_trie_helper(key, data, user_data);
+    }
+}
+
 void complete_against_settings(int argc, char** argv, int pos, GString* output)
 {
     const char* needle;
@@ -621,14 +693,20 @@ void complete_against_settings(int argc, char** argv, int pos, GString* output)
     } else {
         needle = argv[pos];
     }
+    struct HSTrieCompletion data = { needle, output };
     bool is_toggle_command = !strcmp(argv[0], "toggle");
     // complete with setting name
-    for (int i = 0; i < settings_count(); i++) {
-        SettingsPair* sp = settings_get_by_index(i);
-        if (is_toggle_command && sp->type != HS_Int) {
-            continue;
-        }
-        try_complete(needle, sp->name, output);
+    trie_foreach_prefix(settings_name_trie(), needle,
+        is_toggle_command ? complete_against_int_settings_helper
+                          : complete_against_trie_helper,
+        &data);
+}
+
+// completes setting names at the odd positions of NAME VALUE pairs
+void complete_against_setting_names(int argc, char** argv, int pos,
+                                    GString* output) {
+    if (pos % 2 == 1) {
+        complete_against_settings(argc, argv, pos, output);
     }
 }
 
@@ -647,14 +725,13 @@ static bool parameter_expected(int argc, char** argv, int pos) {
         /* no parameter if there is no command */
         return false;
     }
-    for (int i = 0; i < LENGTH(g_parameter_expected)
-                    && g_parameter_expected[i].command; i++) {
+    GArray* indices = (GArray*)trie_lookup(g_parameter_expected_trie, argv[0]);
+    for (int j = 0; indices && j < indices->len; j++) {
+        int i = g_array_index(indices, int, j);
         if (pos < g_parameter_expected[i].min_index) {
             continue;
         }
-        if (!strcmp(g_parameter_expected[i].command, argv[0])) {
-            return g_parameter_expected[i].function(argc, argv, pos);
-        }
+        return g_parameter_expected[i].function(argc, argv, pos);
     }
     return true;
 }
@@ -776,10 +853,7 @@ int complete_against_commands(int argc, char** argv, int position,
     // complete command
     if (position == 0) {
         char* str = (argc >= 1) ? argv[0] : NULL;
-        for (int i = 0; g_commands[i].cmd.standard != NULL; i++) {
-            // only check the first len bytes
-            try_complete(str, g_commands[i].name, output);
-        }
+        complete_against_trie(str, g_command_trie, output);
         return 0;
     }
     if (!parameter_expected(argc, argv, position)) {
@@ -787,17 +861,17 @@ int complete_against_commands(int argc, char** argv, int position,
     }
     if (argc >= 1) {
         const char* cmd_str = (argc >= 1) ? argv[0] : "";
+        GArray* indices = (GArray*)trie_lookup(g_completions_trie, cmd_str);
         // complete parameters for commands
-        for (int i = 0; i < LENGTH(g_completions); i++) {
+        for (int j = 0; indices && j < indices->len; j++) {
+            int i = g_array_index(indices, int, j);
             bool matches = false;
             switch (g_completions[i].relation) {
                 case LE: matches = position <= g_completions[i].index; break;
                 case EQ: matches = position == g_completions[i].index; break;
                 case GE: matches = position >= g_completions[i].index; break;
             }
-            if (!matches
-                || !g_completions[i].command
-                || strcmp(cmd_str, g_completions[i].command)) {
+            if (!matches) {
                 continue;
             }
             const char* needle = (position < argc) ? argv[position] : "";
@@ -1005,6 +1079,33 @@ int command_chain_command(int argc, char** argv, GString* output) {
     return command_chain(separator, condition, argc, argv, output);
 }
 
+// defers all side effects of the commands called until batch_end()
+void batch_begin() {
+    monitors_lock();
+    settings_batch_begin();
+    ewmh_batch_begin();
+    hook_batch_begin();
+}
+
+void batch_end() {
+    // settings callbacks may relayout, so run them while still locked
+    settings_batch_end();
+    monitors_unlock();
+    ewmh_batch_end();
+    hook_batch_end();
+}
+
+int batch_command(int argc, char** argv, GString* output) {
+    if (argc <= 1) {
+        return HERBST_NEED_MORE_ARGS;
+    }
+    (void)SHIFT(argc, argv);
+    batch_begin();
+    int status = call_command(argc, argv, output);
+    batch_end();
+    return status;
+}
+
 int negate_command(int argc, char** argv, GString* output) {
     if (argc <= 1) {
         return HERBST_NEED_MORE_ARGS;
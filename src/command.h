@@ -41,6 +41,11 @@ typedef struct CommandBinding {
 
 extern CommandBinding g_commands[];
 
+struct HSTrie;
+
+void command_init();
+void command_destroy();
+
 int call_command(int argc, char** argv, GString* output);
 int call_command_no_output(int argc, char** argv);
 int call_command_substitute(char* needle, char* replacement,
@@ -58,6 +63,7 @@ void try_complete_prefix(const char* needle, const char* to_check,
                          const char* prefix, GString* output);
 
 void complete_settings(char* str, GString* output);
+void complete_against_trie(const char* needle, struct HSTrie* trie, GString* output);
 void complete_against_list(char* needle, char** list, GString* output);
 void complete_against_tags(int argc, char** argv, int pos, GString* output);
 void complete_against_monitors(int argc, char** argv, int pos, GString* output);
@@ -70,6 +76,8 @@ void complete_against_winids(int argc, char** argv, int pos, GString* output);
 void complete_merge_tag(int argc, char** argv, int pos, GString* output);
 void complete_negate(int argc, char** argv, int pos, GString* output);
 void complete_against_settings(int argc, char** argv, int pos, GString* output);
+void complete_against_setting_names(int argc, char** argv, int pos,
+                                    GString* output);
 void complete_against_keybinds(int argc, char** argv, int pos, GString* output);
 int complete_against_commands(int argc, char** argv, int position,
                               GString* output);
@@ -98,5 +106,8 @@ void complete_against_user_attr_prefix(int argc, char** argv, int position,
 int command_chain_command(int argc, char** argv, GString* output);
 
 int negate_command(int argc, char** argv, GString* output);
+void batch_begin();
+void batch_end();
+int batch_command(int argc, char** argv, GString* output);
 #endif
 
@@ -4,6 +4,7 @@
 #include "globals.h"
 #include "settings.h"
 #include "ewmh.h"
+#include "x11-utils.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -35,8 +36,8 @@ static void decoration_update_frame_extents(struct HSClient* client);
 
 void decorations_init() {
     g_theme_object = hsobject_create_and_link(hsobject_root(), "theme");
-    g_pseudotile_center_threshold = &(settings_find("pseudotile_center_threshold")->value.i);
-    g_update_dragged_clients = &(settings_find("update_dragged_clients")->value.i);
+    g_pseudotile_center_threshold = &(settings_by_id(SETTING_PSEUDOTILE_CENTER_THRESHOLD)->value.i);
+    g_update_dragged_clients = &(settings_by_id(SETTING_UPDATE_DRAGGED_CLIENTS)->value.i);
     g_decwin2client = g_hash_table_new(g_int_hash, g_int_equal);
     // init default schemes
     // tiling //
@@ -251,7 +252,7 @@ static Visual* check_32bit_client(HSClient* c)
     XWindowAttributes wattrib;
     Status ret;
 
-    ret = XGetWindowAttributes(g_display, c->window, &wattrib);
+    ret = X11_ROUND_TRIP(XGetWindowAttributes(g_display, c->window, &wattrib));
     HSWeakAssert(ret != BadDrawable);
     HSWeakAssert(ret != BadWindow);
 
@@ -285,6 +286,7 @@ void decoration_setup_frame(HSClient* client) {
     dec->depth = visual
                  ? 32
                  : (DefaultDepth(g_display, DefaultScreen(g_display)));
+    dec->parent = g_root;
     dec->decwin = XCreateWindow(g_display, g_root, 0,0, 30, 30, 0,
                         dec->depth,
                         InputOutput,
@@ -457,7 +459,7 @@ void decoration_resize_outline(HSClient* client, Rectangle outline,
     if (!client->dragged || *g_update_dragged_clients) {
         client_send_configure(client);
     }
-    XSync(g_display, False);
+    X11_ROUND_TRIP(XSync(g_display, False));
 }
 
 static void decoration_update_frame_extents(struct HSClient* client) {
@@ -486,9 +488,10 @@ static unsigned int get_client_color(HSClient* client, unsigned int pixel) {
         XColor xcol;
         xcol.pixel = pixel;
         /* get rbg value out of default colormap */
-        XQueryColor(g_display, DefaultColormap(g_display, g_screen), &xcol);
+        X11_ROUND_TRIP(XQueryColor(g_display,
+                                   DefaultColormap(g_display, g_screen), &xcol));
         /* get pixel value back appropriate for client */
-        XAllocColor(g_display, client->dec.colormap, &xcol);
+        X11_ROUND_TRIP(XAllocColor(g_display, client->dec.colormap, &xcol));
         return xcol.pixel;
     } else {
         return pixel;
@@ -39,6 +39,7 @@ typedef struct {
 typedef struct {
     struct HSClient*        client; // the client to decorate
     Window                  decwin; // the decoration winodw
+    Window                  parent; // g_root or the container of the tag
     HSDecorationScheme      last_scheme;
     bool                    last_rect_inner; // whether last_rect is inner size
     Rectangle               last_inner_rect; // only valid if width >= 0
@@ -5,6 +5,7 @@
 
 #include "ewmh.h"
 #include "utils.h"
+#include "x11-utils.h"
 #include "globals.h"
 #include "layout.h"
 #include "clientlist.h"
@@ -27,6 +28,7 @@
 Atom g_netatom[NetCOUNT];
 
 // module internal globals:
+static GHashTable* g_netatom_index; // Atom -> index in g_netatom + 1
 static Window*     g_windows; // array with Window-IDs
 static size_t      g_window_count;
 static Window      g_wm_window;
@@ -38,6 +40,28 @@ static Window*  g_original_clients = NULL;
 static unsigned long g_original_clients_count = 0;
 static bool ewmh_read_client_list(Window** buf, unsigned long *count);
 
+// root window properties that still need to be written when a batch ends
+enum {
+    EWMH_DIRTY_CLIENT_LIST          = 1 << 0,
+    EWMH_DIRTY_CLIENT_LIST_STACKING = 1 << 1,
+    EWMH_DIRTY_DESKTOPS             = 1 << 2,
+    EWMH_DIRTY_DESKTOP_NAMES        = 1 << 3,
+    EWMH_DIRTY_CURRENT_DESKTOP      = 1 << 4,
+    EWMH_DIRTY_ACTIVE_WINDOW        = 1 << 5,
+};
+static int      g_ewmh_batch_depth = 0;
+static int      g_ewmh_dirty = 0;
+static Window   g_ewmh_active_window = None; // deferred _NET_ACTIVE_WINDOW
+
+// returns whether the update of the given property has to be deferred
+static bool ewmh_defer(int flag) {
+    if (g_ewmh_batch_depth > 0) {
+        g_ewmh_dirty |= flag;
+        return true;
+    }
+    return false;
+}
+
 /* list of names of all _NET-atoms */
 const std::array<const char*,NetCOUNT>g_netatom_names =
   ArrayInitializer<const char*,NetCOUNT>({
@@ -81,7 +105,7 @@ const std::array<const char*,NetCOUNT>g_netatom_names =
 void ewmh_init() {
     /* init globals */
     g_focus_stealing_prevention =
-        &(settings_find("focus_stealing_prevention")->value.i);
+        &(settings_by_id(SETTING_FOCUS_STEALING_PREVENTION)->value.i);
 
     /* init ewmh net atoms */
     for (int i = 0; i < NetCOUNT; i++) {
@@ -90,7 +114,14 @@ void ewmh_init() {
                       "for atom number %d\n", i);
             continue;
         }
-        g_netatom[i] = XInternAtom(g_display, g_netatom_names[i], False);
+        g_netatom[i] = ATOM(g_netatom_names[i]);
+    }
+    g_netatom_index = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (int i = 0; i < NetCOUNT; i++) {
+        if (g_netatom[i] != None) {
+            g_hash_table_insert(g_netatom_index, GUINT_TO_POINTER(g_netatom[i]),
+                                GINT_TO_POINTER(i + 1));
+        }
     }
 
     /* tell which ewmh atoms are supported */
@@ -107,7 +138,7 @@ void ewmh_init() {
     }
 
     /* init other atoms */
-    WM_STATE = XInternAtom(g_display, "WM_STATE", False);
+    WM_STATE = ATOM("WM_STATE");
 
     /* init for the supporting wm check */
     g_wm_window = XCreateSimpleWindow(g_display, g_root,
@@ -133,7 +164,39 @@ void ewmh_update_all() {
     ewmh_update_desktop_names();
 }
 
+void ewmh_batch_begin() {
+    g_ewmh_batch_depth++;
+}
+
+void ewmh_batch_end() {
+    HSAssert(g_ewmh_batch_depth > 0);
+    if (--g_ewmh_batch_depth > 0) {
+        return;
+    }
+    int dirty = g_ewmh_dirty;
+    g_ewmh_dirty = 0;
+    if (dirty & EWMH_DIRTY_CLIENT_LIST) {
+        ewmh_update_client_list();
+    }
+    if (dirty & EWMH_DIRTY_CLIENT_LIST_STACKING) {
+        ewmh_update_client_list_stacking();
+    }
+    if (dirty & EWMH_DIRTY_DESKTOPS) {
+        ewmh_update_desktops();
+    }
+    if (dirty & EWMH_DIRTY_DESKTOP_NAMES) {
+        ewmh_update_desktop_names();
+    }
+    if (dirty & EWMH_DIRTY_CURRENT_DESKTOP) {
+        ewmh_update_current_desktop();
+    }
+    if (dirty & EWMH_DIRTY_ACTIVE_WINDOW) {
+        ewmh_update_active_window(g_ewmh_active_window);
+    }
+}
+
 void ewmh_destroy() {
+    g_hash_table_destroy(g_netatom_index);
     g_free(g_windows);
     if (g_original_clients) {
         XFree(g_original_clients);
@@ -152,10 +215,13 @@ void ewmh_set_wmname(char* name) {
 }
 
 void ewmh_update_wmname() {
-    ewmh_set_wmname(settings_find_string("wmname"));
+    ewmh_set_wmname(settings_by_id(SETTING_WMNAME)->value.str->str);
 }
 
 void ewmh_update_client_list() {
+    if (ewmh_defer(EWMH_DIRTY_CLIENT_LIST)) {
+        return;
+    }
     XChangeProperty(g_display, g_root, g_netatom[NetClientList],
         XA_WINDOW, 32, PropModeReplace,
         (unsigned char *) g_windows, g_window_count);
@@ -165,9 +231,9 @@ static bool ewmh_read_client_list(Window** buf, unsigned long *count) {
     Atom actual_type;
     int format;
     unsigned long bytes_left;
-    if (Success != XGetWindowProperty(g_display, g_root,
+    if (Success != X11_ROUND_TRIP(XGetWindowProperty(g_display, g_root,
             g_netatom[NetClientList], 0, ~0L, False, XA_WINDOW, &actual_type,
-            &format, count, &bytes_left, (unsigned char**)buf)) {
+            &format, count, &bytes_left, (unsigned char**)buf))) {
         return false;
     }
     if (bytes_left || actual_type != XA_WINDOW || format != 32) {
@@ -205,6 +271,9 @@ static void ewmh_add_tag_stack(HSTag* tag, void* data) {
 }
 
 void ewmh_update_client_list_stacking() {
+    if (ewmh_defer(EWMH_DIRTY_CLIENT_LIST_STACKING)) {
+        return;
+    }
     // First: get the windows in the current stack
     struct ewmhstack stack;
     stack.count = g_window_count;
@@ -249,12 +318,18 @@ void ewmh_remove_client(Window win) {
 }
 
 void ewmh_update_desktops() {
+    if (ewmh_defer(EWMH_DIRTY_DESKTOPS)) {
+        return;
+    }
     int cnt = tag_get_count();
     XChangeProperty(g_display, g_root, g_netatom[NetNumberOfDesktops],
         XA_CARDINAL, 32, PropModeReplace, (unsigned char*)&cnt, 1);
 }
 
 void ewmh_update_desktop_names() {
+    if (ewmh_defer(EWMH_DIRTY_DESKTOP_NAMES)) {
+        return;
+    }
     char**  names = g_new(char*, tag_get_count());
     for (int i = 0; i < tag_get_count(); i++) {
         names[i] = get_tag_by_index(i)->name->str;
@@ -268,6 +343,9 @@ void ewmh_update_desktop_names() {
 }
 
 void ewmh_update_current_desktop() {
+    if (ewmh_defer(EWMH_DIRTY_CURRENT_DESKTOP)) {
+        return;
+    }
     HSTag* tag = get_current_monitor()->tag;
     int index = tag_index_of(tag);
     if (index < 0) {
@@ -284,11 +362,19 @@ void ewmh_window_update_tag(Window win, HSTag* tag) {
         g_warning("tag %s not found in internal list\n", tag->name->str);
         return;
     }
+    ewmh_window_update_desktop(win, index);
+}
+
+void ewmh_window_update_desktop(Window win, int index) {
     XChangeProperty(g_display, win, g_netatom[NetWmDesktop],
         XA_CARDINAL, 32, PropModeReplace, (unsigned char*)&(index), 1);
 }
 
 void ewmh_update_active_window(Window win) {
+    g_ewmh_active_window = win;
+    if (ewmh_defer(EWMH_DIRTY_ACTIVE_WINDOW)) {
+        return;
+    }
     XChangeProperty(g_display, g_root, g_netatom[NetActiveWindow],
         XA_WINDOW, 32, PropModeReplace, (unsigned char*)&(win), 1);
 }
@@ -303,16 +389,17 @@ static bool focus_stealing_allowed(long source) {
     }
 }
 
+int ewmh_atom_index(Atom atom) {
+    gpointer index = g_hash_table_lookup(g_netatom_index,
+                                         GUINT_TO_POINTER(atom));
+    return GPOINTER_TO_INT(index) - 1;
+}
+
 void ewmh_handle_client_message(XEvent* event) {
     HSDebug("Received event: ClientMessage\n");
     XClientMessageEvent* me = &(event->xclient);
-    int index;
-    for (index = 0; index < NetCOUNT; index++) {
-        if (me->message_type == g_netatom[index]) {
-            break;
-        }
-    }
-    if (index >= NetCOUNT) {
+    int index = ewmh_atom_index(me->message_type);
+    if (index < 0) {
         HSDebug("received unknown client message\n");
         return;
     }
@@ -465,9 +552,9 @@ bool ewmh_is_window_state_set(Window win, Atom hint) {
     Atom actual_type;
     int format;
     unsigned long actual_count, bytes_left;
-    if (Success != XGetWindowProperty(g_display, win, g_netatom[NetWmState], 0,
-            ~0L, False, XA_ATOM, &actual_type, &format, &actual_count,
-            &bytes_left, (unsigned char**)&states)) {
+    if (Success != X11_ROUND_TRIP(XGetWindowProperty(g_display, win,
+            g_netatom[NetWmState], 0, ~0L, False, XA_ATOM, &actual_type, &format, &actual_count,
+            &bytes_left, (unsigned char**)&states))) {
         // NetWmState just is not set properly
         return false;
     }
@@ -505,7 +592,7 @@ int ewmh_get_window_type(Window win) { // returns an element of the NetWm-Enum
     unsigned long items, bytes_left;
     long offset = 0;
 
-    int status = XGetWindowProperty(
+    int status = X11_ROUND_TRIP(XGetWindowProperty(
             g_display,
             win,
             g_netatom[NetWmWindowType],
@@ -518,7 +605,7 @@ int ewmh_get_window_type(Window win) { // returns an element of the NetWm-Enum
             &items,
             &bytes_left,
             (unsigned char**)&buf
-            );
+            ));
     // we only need precisely four bytes (one Atom)
     // if there are bytes left, something went wrong
     if(status != Success || bytes_left > 0 || items < 1 || buf == NULL) {
@@ -528,13 +615,11 @@ int ewmh_get_window_type(Window win) { // returns an element of the NetWm-Enum
         XFree(buf);
     }
 
-    for (int i = NetWmWindowTypeFIRST; i <= NetWmWindowTypeLAST; i++) {
-        // try to find the window type
-        if (wintype == g_netatom[i]) {
-            return i;
-        }
+    int index = ewmh_atom_index(wintype);
+    if (index < NetWmWindowTypeFIRST || index > NetWmWindowTypeLAST) {
+        return -1;
     }
-    return -1;
+    return index;
 }
 
 bool ewmh_is_desktop_window(Window win) {
@@ -83,7 +83,13 @@ extern const std::array<const char*,NetCOUNT> g_netatom_names;
 
 void ewmh_init();
 void ewmh_destroy();
+// returns the index of atom in g_netatom, or -1 if it is no _NET-atom
+int ewmh_atom_index(Atom atom);
 void ewmh_update_all();
+// while a batch is open, updates of the root window properties are only
+// recorded and then written once when the outermost batch ends
+void ewmh_batch_begin();
+void ewmh_batch_end();
 
 void ewmh_add_client(Window win);
 void ewmh_remove_client(Window win);
@@ -107,6 +113,7 @@ void ewmh_clear_client_properties(struct HSClient* client);
 
 // set the desktop property of a window
 void ewmh_window_update_tag(Window win, struct HSTag* tag);
+void ewmh_window_update_desktop(Window win, int index);
 
 void ewmh_handle_client_message(XEvent* event);
 
@@ -0,0 +1,254 @@
+/** Copyright 2011-2014 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#include "geometry.h"
+
+#include <stdlib.h>
+#include <limits.h>
+#include <algorithm>
+#include <utility>
+
+enum HSDirection char_to_direction(char ch) {
+    switch (ch) {
+        case 'u': return DirUp;
+        case 'r': return DirRight;
+        case 'l': return DirLeft;
+        case 'd': return DirDown;
+        default:  return (HSDirection)-1;
+    }
+}
+
+// rectlist_rotate rotates the list of given rectangles, s.t. the direction dir
+// becomes the direction "right". idx is some distinguished element, whose
+// index may change
+static void rectlist_rotate(RectangleIdx* rects, size_t cnt, int* idx,
+                                enum HSDirection dir) {
+    switch (dir) {
+        case DirRight:
+            return; // nothing to do
+        case DirUp:
+            // just flip by the horizontal axis
+            for (int i = 0; i < cnt; i++) {
+                Rectangle* r = &(rects[i].r);
+                r->y = - r->y - r->height;
+            }
+            // and flip order to reverse the order for rectangles with the same
+            // center
+            for (int i = 0; i < (cnt - 1 - i); i++) {
+                int j = (cnt - 1 - i);
+                std::swap(rects[i], rects[j]);
+            }
+            *idx = cnt - 1 - *idx;
+            // and then direction up now has become direction down
+        case DirDown:
+            // flip by the diagonal
+            //
+            //   *-------------> x     *-------------> x
+            //   |   +------+          |   +---+[]
+            //   |   |      |     ==>  |   |   |
+            //   |   +------+          |   |   |
+            //   |   []                |   +---+
+            //   V                     V
+            for (int i = 0; i < cnt; i++) {
+                Rectangle* r = &(rects[i].r);
+                std::swap(r->x, r->y);
+                std::swap(r->height, r->width);
+            }
+            return;
+        case DirLeft:
+            // flip by the vertical axis
+            for (int i = 0; i < cnt; i++) {
+                Rectangle* r = &(rects[i].r);
+                r->x = - r->x - r->width;
+            }
+            // and flip order to reverse the order for rectangles with the same
+            // center
+            for (int i = 0; i < (cnt - 1 - i); i++) {
+                int j = (cnt - 1 - i);
+                std::swap(rects[i], rects[j]);
+            }
+            *idx = cnt - 1 - *idx;
+            return;
+    }
+}
+
+// returns the found index in the original buffer
+int find_rectangle_in_direction(RectangleIdx* rects, size_t cnt, int idx,
+                                enum HSDirection dir) {
+    rectlist_rotate(rects, cnt, &idx, dir);
+    return find_rectangle_right_of(rects, cnt, idx);
+}
+
+static bool rectangle_is_right_of(Rectangle RC, Rectangle R2) {
+    int cx = RC.x + RC.width / 2;
+    int cy = RC.y + RC.height / 2;
+    // only consider rectangles right of that with specified idx, called RC. A
+    // rectangle R2 is considered right, if the angle of the vector from the
+    // center of RC to the center of R2 is in the interval [-45 deg, + 45 deg].
+    // In a picture:   ...
+    //                /
+    //   RC +----------+
+    //      |      /   |   area right of RC
+    //      |    c     |
+    //      |      \   |
+    //      +----------+
+    //                \...
+    int rcx = R2.x + R2.width / 2;
+    int rcy = R2.y + R2.height / 2;
+    // get vector from center of RC to center of R2
+    rcx -= cx;
+    rcy -= cy;
+    if (rcx < 0) return false;
+    if (abs(rcy) > rcx) return false;
+    if (rcx == 0 && rcy == 0) {
+        // if centers match, then disallow R2 to have a larger width
+        return true;
+    }
+    return true;
+}
+
+int find_rectangle_right_of(RectangleIdx* rects, size_t cnt, int idx) {
+    Rectangle RC = rects[idx].r;
+    int cx = RC.x + RC.width / 2;
+    int cy = RC.y + RC.height / 2;
+    int write_i = 0; // next rectangle to write
+    // filter out rectangles not right of RC
+    for (int i = 0; i < cnt; i++) {
+        if (idx == i) continue;
+        Rectangle R2 = rects[i].r;
+        int rcx = R2.x + R2.width / 2;
+        int rcy = R2.y + R2.height / 2;
+        if (!rectangle_is_right_of(RC, R2)) continue;
+        // if two rectangles have exactly the same geometry, then sort by index
+        // compare centers and not topleft corner because rectangle_is_right_of
+        // does it the same way
+        if (rcx == cx && rcy == cy) {
+            if (i < idx) continue;
+        }
+        if (i == write_i) { write_i++; }
+        else {
+            rects[write_i++] = rects[i];
+        }
+    }
+    // find the rectangle with the smallest distance to RC
+    if (write_i == 0) return -1;
+    int idxbest = -1;
+    int ibest = -1;
+    int distbest = INT_MAX;
+    for (int i = 0; i < write_i; i++) {
+        Rectangle R2 = rects[i].r;
+        int rcx = R2.x + R2.width / 2;
+        int rcy = R2.y + R2.height / 2;
+                            // another method that checks the closes point
+        int anchor_y = rcy; // (rcy > cy) ? rcy : MIN(rcy + R2.height, cy);
+        int anchor_x = rcx; // MAX(cx, R2.x);
+        // get manhatten distance to the anchor
+        int dist = abs(anchor_x - cx) + abs(anchor_y - cy);
+        if (dist < distbest
+            || (dist == distbest && ibest > i)) {
+            distbest = dist;
+            idxbest = rects[i].idx;
+            ibest = i;
+        }
+    }
+    return idxbest;
+}
+
+// returns the found index in the modified buffer
+int find_edge_in_direction(RectangleIdx* rects, size_t cnt, int idx,
+                                enum HSDirection dir) {
+    rectlist_rotate(rects, cnt, &idx, dir);
+    int found = find_edge_right_of(rects, cnt, idx);
+    if (found < 0) return found;
+    // rotate back, by requesting the inverse rotation
+    //switch (dir) {
+    //    case DirLeft: break; // DirLeft is inverse to itself
+    //    case DirRight: break; // DirRight is the identity
+    //    case DirUp: dir = DirDown; break; // once was rotated 90 deg counterclockwise..
+    //                                      // now has to be rotate 90 deg clockwise back
+    //    case DirDown: dir = DirUp; break;
+    //}
+    rectlist_rotate(rects, cnt, &found, dir);
+    rectlist_rotate(rects, cnt, &found, dir);
+    rectlist_rotate(rects, cnt, &found, dir);
+    return found;
+}
+int find_edge_right_of(RectangleIdx* rects, size_t cnt, int idx) {
+    int xbound = rects[idx].r.x + rects[idx].r.width;
+    int ylow = rects[idx].r.y;
+    int yhigh = rects[idx].r.y + rects[idx].r.height;
+    // only keep rectangles with a x coordinate right of the xbound
+    // and with an appropriate y/height
+    //
+    //      +---------+ - - - - - - - - - - -
+    //      |   idx   |   area of intrest
+    //      +---------+ - - - - - - - - - - -
+    int leftmost = -1;
+    int dist = INT_MAX;
+    for (int i = 0; i < cnt; i++) {
+        if (i == idx) continue;
+        if (rects[i].r.x <= xbound) continue;
+        int low = rects[i].r.y;
+        int high = low + rects[i].r.height;
+        if (!intervals_intersect(ylow, yhigh, low, high)) {
+            continue;
+        }
+        if (rects[i].r.x - xbound < dist) {
+            dist = rects[i].r.x - xbound;
+            leftmost = i;
+        }
+    }
+    return leftmost;
+}
+
+bool intervals_intersect(int a_left, int a_right, int b_left, int b_right) {
+    return (b_left < a_right) && (a_left < b_right);
+}
+
+// from dwm.c
+void size_hints_apply(const HSSizeHints* c, int* w, int* h) {
+    bool baseismin;
+
+    /* set minimum possible */
+    *w = std::max(1, *w);
+    *h = std::max(1, *h);
+    if(*h < WINDOW_MIN_HEIGHT)
+        *h = WINDOW_MIN_HEIGHT;
+    if(*w < WINDOW_MIN_WIDTH)
+        *w = WINDOW_MIN_WIDTH;
+    if(c) {
+        /* see last two sentences in ICCCM 4.1.2.3 */
+        baseismin = c->basew == c->minw && c->baseh == c->minh;
+        if(!baseismin) { /* temporarily remove base dimensions */
+            *w -= c->basew;
+            *h -= c->baseh;
+        }
+        /* adjust for aspect limits */
+        if(c->mina > 0 && c->maxa > 0) {
+            if(c->maxa < (float)*w / *h)
+                *w = *h * c->maxa + 0.5;
+            else if(c->mina < (float)*h / *w)
+                *h = *w * c->mina + 0.5;
+        }
+        if(baseismin) { /* increment calculation requires this */
+            *w -= c->basew;
+            *h -= c->baseh;
+        }
+        /* adjust for increment value */
+        if(c->incw)
+            *w -= *w % c->incw;
+        if(c->inch)
+            *h -= *h % c->inch;
+        /* restore base dimensions */
+        *w += c->basew;
+        *h += c->baseh;
+        *w = std::max(*w, c->minw);
+        *h = std::max(*h, c->minh);
+        if(c->maxw)
+            *w = std::min(*w, c->maxw);
+        if(c->maxh)
+            *h = std::min(*h, c->maxh);
+    }
+}
@@ -0,0 +1,55 @@
+/** Copyright 2011-2014 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#ifndef __HERBST_GEOMETRY_H_
+#define __HERBST_GEOMETRY_H_
+
+// Geometric computations that do not depend on the X server or on any
+// global state, such that they can be benchmarked without an X server. See
+// benchmark/bench-layout.cpp.
+
+#include "x11-types.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+#define WINDOW_MIN_HEIGHT 32
+#define WINDOW_MIN_WIDTH 32
+
+enum HSDirection {
+    DirRight,
+    DirLeft,
+    DirUp,
+    DirDown,
+};
+
+typedef struct {
+    Rectangle r;
+    int       idx;
+} RectangleIdx;
+
+// the size hints of a window as defined by the ICCCM
+typedef struct {
+    float mina, maxa;
+    int basew, baseh, incw, inch, maxw, maxh, minw, minh;
+} HSSizeHints;
+
+enum HSDirection char_to_direction(char ch);
+// tells if the intervals [a_left, a_right) [b_left, b_right) intersect
+bool intervals_intersect(int a_left, int a_right, int b_left, int b_right);
+
+// directional search, rects is modified by all of them
+int find_rectangle_in_direction(RectangleIdx* rects, size_t cnt, int idx,
+                                enum HSDirection dir);
+int find_rectangle_right_of(RectangleIdx* rects, size_t cnt, int idx);
+int find_edge_in_direction(RectangleIdx* rects, size_t cnt, int idx,
+                                enum HSDirection dir);
+int find_edge_right_of(RectangleIdx* rects, size_t cnt, int idx);
+
+// restricts the size w x h to the minimum window size and, if hints is
+// given, to the size hints
+void size_hints_apply(const HSSizeHints* hints, int* w, int* h);
+
+#endif
+
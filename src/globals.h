@@ -8,6 +8,7 @@
 
 #include <stdbool.h>
 #include <X11/Xlib.h>
+#include "geometry.h"
 
 #define HERBSTLUFT_AUTOSTART "herbstluftwm/autostart"
 #define WINDOW_MANAGER_NAME "herbstluftwm"
@@ -16,8 +17,6 @@
 
 #define HERBST_FRAME_CLASS "_HERBST_FRAME"
 #define HERBST_DECORATION_CLASS "_HERBST_DECORATION"
-#define WINDOW_MIN_HEIGHT 32
-#define WINDOW_MIN_WIDTH 32
 
 #define ROOT_EVENT_MASK (SubstructureRedirectMask|SubstructureNotifyMask|ButtonPressMask|EnterWindowMask|LeaveWindowMask|StructureNotifyMask)
 //#define CLIENT_EVENT_MASK (PropertyChangeMask | FocusChangeMask | StructureNotifyMask)
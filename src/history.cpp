@@ -0,0 +1,329 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#include "history.h"
+
+#include "globals.h"
+#include "ipc-protocol.h"
+#include "utils.h"
+#include "layout.h"
+#include "tag.h"
+#include "monitor.h"
+#include "clientlist.h"
+#include "settings.h"
+#include "state.h"
+
+#include <string.h>
+
+static int* g_layout_history_size;
+
+void history_init() {
+    g_layout_history_size = &(settings_by_id(SETTING_LAYOUT_HISTORY_SIZE)->value.i);
+}
+
+void history_destroy() {
+}
+
+static HSFrameSnapshot* snapshot_ref(HSFrameSnapshot* snap) {
+    snap->refcount++;
+    return snap;
+}
+
+static void snapshot_unref(HSFrameSnapshot* snap) {
+    if (!snap || --snap->refcount > 0) {
+        return;
+    }
+    if (snap->type == TYPE_FRAMES) {
+        snapshot_unref(snap->content.layout.a);
+        snapshot_unref(snap->content.layout.b);
+    } else {
+        g_free(snap->content.clients.wins);
+    }
+    g_free(snap);
+}
+
+static void snapshot_unref_cb(gpointer snap, gpointer data) {
+    (void)data;
+    snapshot_unref((HSFrameSnapshot*)snap);
+}
+
+static void snapshot_queue_clear(GQueue* queue) {
+    g_queue_foreach(queue, snapshot_unref_cb, NULL);
+    g_queue_clear(queue);
+}
+
+/* creates a snapshot of the given frame. If a subtree equals the
+ * corresponding subtree of prev, then the node of prev is reused. So if the
+ * entire frame did not change compared to prev, then prev itself is returned.
+ * The caller owns a reference to the returned snapshot.
+ */
+static HSFrameSnapshot* snapshot_create(HSFrame* frame, HSFrameSnapshot* prev) {
+    if (prev && prev->type != frame->type) {
+        prev = NULL;
+    }
+    if (frame->type == TYPE_FRAMES) {
+        HSLayout* layout = &frame->content.layout;
+        HSFrameSnapshot* a = snapshot_create(layout->a,
+                                prev ? prev->content.layout.a : NULL);
+        HSFrameSnapshot* b = snapshot_create(layout->b,
+                                prev ? prev->content.layout.b : NULL);
+        if (prev
+            && prev->content.layout.a == a
+            && prev->content.layout.b == b
+            && prev->content.layout.align == layout->align
+            && prev->content.layout.fraction == layout->fraction
+            && prev->content.layout.selection == layout->selection) {
+            snapshot_unref(a);
+            snapshot_unref(b);
+            return snapshot_ref(prev);
+        }
+        HSFrameSnapshot* snap = g_new0(HSFrameSnapshot, 1);
+        snap->refcount = 1;
+        snap->type = TYPE_FRAMES;
+        snap->content.layout.align = layout->align;
+        snap->content.layout.fraction = layout->fraction;
+        snap->content.layout.selection = layout->selection;
+        snap->content.layout.a = a;
+        snap->content.layout.b = b;
+        return snap;
+    } else {
+        HSClient** buf = frame->content.clients.buf;
+        size_t count = frame->content.clients.count;
+        if (prev
+            && prev->content.clients.count == count
+            && prev->content.clients.selection == frame->content.clients.selection
+            && prev->content.clients.layout == frame->content.clients.layout) {
+            size_t i;
+            for (i = 0; i < count; i++) {
+                if (prev->content.clients.wins[i] != buf[i]->window) {
+                    break;
+                }
+            }
+            if (i == count) {
+                return snapshot_ref(prev);
+            }
+        }
+        HSFrameSnapshot* snap = g_new0(HSFrameSnapshot, 1);
+        snap->refcount = 1;
+        snap->type = TYPE_CLIENTS;
+        snap->content.clients.wins = g_new(Window, count);
+        for (size_t i = 0; i < count; i++) {
+            snap->content.clients.wins[i] = buf[i]->window;
+        }
+        snap->content.clients.count = count;
+        snap->content.clients.selection = frame->content.clients.selection;
+        snap->content.clients.layout = frame->content.clients.layout;
+        return snap;
+    }
+}
+
+// the clients of a tag while its layout is restored from a snapshot
+typedef struct {
+    HSTag*      tag;
+    GArray*     clients;    // HSClient*, in the order of the old layout
+    GHashTable* unplaced;   // HSClient* that are not in a frame yet
+} HSSnapshotLoad;
+
+// takes all clients out of the frames below frame, without changing the
+// structure of the frame tree
+static void frame_detach_clients(HSFrame* frame, HSSnapshotLoad* load) {
+    if (frame->type == TYPE_FRAMES) {
+        frame_detach_clients(frame->content.layout.a, load);
+        frame_detach_clients(frame->content.layout.b, load);
+        return;
+    }
+    for (size_t i = 0; i < frame->content.clients.count; i++) {
+        HSClient* client = frame->content.clients.buf[i];
+        g_array_append_val(load->clients, client);
+        g_hash_table_insert(load->unplaced, client, client);
+    }
+    g_free(frame->content.clients.buf);
+    frame->content.clients.buf = NULL;
+    frame->content.clients.count = 0;
+    frame->content.clients.selection = 0;
+}
+
+// puts client to the end of the client frame if it was detached before and
+// is not placed in any other frame yet
+static void frame_place_client(HSFrame* frame, HSClient* client,
+                               HSSnapshotLoad* load) {
+    if (!client || client->tag != load->tag
+        || !g_hash_table_remove(load->unplaced, client)) {
+        // the client has been closed, moved to another tag or already
+        // placed in the meantime
+        return;
+    }
+    size_t count = frame->content.clients.count;
+    HSClient** buf = g_renew(HSClient*, frame->content.clients.buf, count + 1);
+    buf[count] = client;
+    frame->content.clients.buf = buf;
+    frame->content.clients.count = count + 1;
+}
+
+// does the same as load_frame_tree() but reads the layout from a snapshot.
+// The clients are detached before, so each frame and client is touched only
+// once.
+static void frame_load_snapshot(HSFrame* frame, HSFrameSnapshot* snap,
+                                HSSnapshotLoad* load) {
+    if (snap->type == TYPE_FRAMES) {
+        int align = snap->content.layout.align;
+        int fraction = snap->content.layout.fraction;
+        if (frame->type == TYPE_FRAMES) {
+            frame->content.layout.align = align;
+            frame->content.layout.fraction = fraction;
+        } else if (!frame_split(frame, align, fraction)) {
+            // the clients of the subtree are put to the focused frame later
+            return;
+        }
+        frame->content.layout.selection = snap->content.layout.selection;
+        frame_load_snapshot(frame->content.layout.a, snap->content.layout.a,
+                            load);
+        frame_load_snapshot(frame->content.layout.b, snap->content.layout.b,
+                            load);
+    } else {
+        // all frames below are empty, so this only frees them
+        frame_collapse(frame);
+        for (size_t i = 0; i < snap->content.clients.count; i++) {
+            HSClient* client = get_client_from_window(snap->content.clients.wins[i]);
+            frame_place_client(frame, client, load);
+        }
+        int selection = snap->content.clients.selection;
+        selection = (selection < frame->content.clients.count) ? selection : 0;
+        frame->content.clients.layout = snap->content.clients.layout;
+        frame->content.clients.selection = selection;
+    }
+}
+
+// replaces the layout of the tag by the snapshot. Clients that are on the
+// tag but not in the snapshot are put to the focused frame.
+static void tag_load_snapshot(HSTag* tag, HSFrameSnapshot* snap) {
+    HSSnapshotLoad load;
+    load.tag = tag;
+    load.clients = g_array_new(false, false, sizeof(HSClient*));
+    load.unplaced = g_hash_table_new(g_direct_hash, g_direct_equal);
+    frame_detach_clients(tag->frame, &load);
+    frame_load_snapshot(tag->frame, snap, &load);
+    HSFrame* focus = frame_current_selection_below(tag->frame);
+    for (size_t i = 0; i < load.clients->len; i++) {
+        HSClient* client = g_array_index(load.clients, HSClient*, i);
+        frame_place_client(focus, client, &load);
+    }
+    g_hash_table_destroy(load.unplaced);
+    g_array_free(load.clients, true);
+    state_tag_changed(tag);
+}
+
+HSHistory* history_create() {
+    HSHistory* history = g_new0(HSHistory, 1);
+    history->undo = g_queue_new();
+    history->redo = g_queue_new();
+    return history;
+}
+
+void history_free(HSHistory* history) {
+    snapshot_queue_clear(history->undo);
+    snapshot_queue_clear(history->redo);
+    g_queue_free(history->undo);
+    g_queue_free(history->redo);
+    g_free(history);
+}
+
+static void history_trim(GQueue* queue) {
+    int size = MAX(0, *g_layout_history_size);
+    while (g_queue_get_length(queue) > size) {
+        snapshot_unref((HSFrameSnapshot*)g_queue_pop_tail(queue));
+    }
+}
+
+HSFrameSnapshot* history_begin(HSTag* tag) {
+    if (*g_layout_history_size <= 0) {
+        return NULL;
+    }
+    // share the unchanged subtrees with the last record
+    return snapshot_create(tag->frame,
+                (HSFrameSnapshot*)g_queue_peek_head(tag->history->undo));
+}
+
+void history_commit(HSTag* tag, HSFrameSnapshot* before) {
+    HSHistory* history = tag->history;
+    if (!before) {
+        // the history is disabled
+        snapshot_queue_clear(history->undo);
+        snapshot_queue_clear(history->redo);
+        return;
+    }
+    HSFrameSnapshot* cur = snapshot_create(tag->frame, before);
+    bool changed = cur != before;
+    snapshot_unref(cur);
+    if (!changed) {
+        // e.g. if the command failed, then the redo history is kept
+        snapshot_unref(before);
+        return;
+    }
+    snapshot_queue_clear(history->redo);
+    if (before == g_queue_peek_head(history->undo)) {
+        // the layout before the change is already recorded
+        snapshot_unref(before);
+        return;
+    }
+    g_queue_push_head(history->undo, before);
+    history_trim(history->undo);
+}
+
+/* moves from the current layout to the most recent snapshot in src. The
+ * current layout is pushed to dest.
+ */
+static bool history_step(HSTag* tag, GQueue* src, GQueue* dest) {
+    HSFrameSnapshot* cur = snapshot_create(tag->frame,
+                            (HSFrameSnapshot*)g_queue_peek_head(src));
+    // skip entries that equal the current layout, e.g. if the command
+    // that recorded it did not change anything
+    while (g_queue_peek_head(src) == cur) {
+        snapshot_unref((HSFrameSnapshot*)g_queue_pop_head(src));
+    }
+    HSFrameSnapshot* target = (HSFrameSnapshot*)g_queue_pop_head(src);
+    if (!target) {
+        snapshot_unref(cur);
+        return false;
+    }
+    g_queue_push_head(dest, cur);
+    history_trim(dest);
+    monitors_lock();
+    tag_load_snapshot(tag, target);
+    snapshot_unref(target);
+    tag_set_flags_dirty();
+    HSMonitor* m = find_monitor_with_tag(tag);
+    if (m) {
+        frame_show_recursive(tag->frame);
+        if (get_current_monitor() == m) {
+            frame_focus_recursive(tag->frame);
+        }
+        monitor_apply_layout(m);
+    } else {
+        frame_hide_recursive(tag->frame);
+    }
+    monitors_unlock();
+    return true;
+}
+
+int history_undo_command(int argc, char** argv, GString* output) {
+    HSTag* tag = get_current_monitor()->tag;
+    if (!history_step(tag, tag->history->undo, tag->history->redo)) {
+        g_string_append_printf(output,
+            "%s: Nothing to undo\n", argv[0]);
+        return HERBST_FORBIDDEN;
+    }
+    return 0;
+}
+
+int history_redo_command(int argc, char** argv, GString* output) {
+    HSTag* tag = get_current_monitor()->tag;
+    if (!history_step(tag, tag->history->redo, tag->history->undo)) {
+        g_string_append_printf(output,
+            "%s: Nothing to redo\n", argv[0]);
+        return HERBST_FORBIDDEN;
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#ifndef __HERBSTLUFT_HISTORY_H_
+#define __HERBSTLUFT_HISTORY_H_
+
+#include "glib-backports.h"
+#include <stdbool.h>
+#include <X11/Xlib.h>
+
+struct HSFrame;
+struct HSTag;
+
+// an immutable copy of a frame (and its subframes). Unchanged subtrees are
+// shared between consecutive snapshots, so each history entry only costs the
+// nodes on the path to the frames that changed.
+typedef struct HSFrameSnapshot {
+    int refcount;
+    int type; // TYPE_CLIENTS or TYPE_FRAMES
+    union {
+        struct {
+            int align;
+            int fraction;
+            int selection;
+            struct HSFrameSnapshot* a;
+            struct HSFrameSnapshot* b;
+        } layout;
+        struct {
+            Window* wins;
+            size_t  count;
+            int     selection;
+            int     layout;
+        } clients;
+    } content;
+} HSFrameSnapshot;
+
+typedef struct HSHistory {
+    GQueue* undo; // HSFrameSnapshot*, most recent first
+    GQueue* redo; // HSFrameSnapshot*, most recent first
+} HSHistory;
+
+void history_init();
+void history_destroy();
+
+HSHistory* history_create();
+void history_free(HSHistory* history);
+
+// takes a snapshot of the current layout of the tag. Call it before
+// modifying the layout and pass the result to history_commit() afterwards.
+HSFrameSnapshot* history_begin(struct HSTag* tag);
+// records the snapshot taken by history_begin() if the layout of the tag has
+// changed since then. Otherwise, e.g. if the command failed, the snapshot is
+// dropped and the redo history is kept.
+void history_commit(struct HSTag* tag, HSFrameSnapshot* before);
+
+int history_undo_command(int argc, char** argv, GString* output);
+int history_redo_command(int argc, char** argv, GString* output);
+
+#endif
+
@@ -7,10 +7,12 @@
 #include "globals.h"
 #include "utils.h"
 #include "ipc-protocol.h"
+#include "state.h"
 // std
 #include <assert.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 // other
 #include "glib-backports.h"
 // gui
@@ -20,8 +22,16 @@
 #include <X11/Xatom.h>
 
 static Window g_event_window;
+static Atom g_hook_atoms[HERBST_HOOK_PROPERTY_COUNT];
+static int g_hook_batch_depth = 0;
+static GQueue g_pending_hooks = G_QUEUE_INIT; // NULL-terminated char**
 
 void hook_init() {
+    char atom_name[STRING_BUF_SIZE];
+    for (int i = 0; i < HERBST_HOOK_PROPERTY_COUNT; i++) {
+        snprintf(atom_name, STRING_BUF_SIZE, HERBST_HOOK_PROPERTY_FORMAT, i);
+        g_hook_atoms[i] = ATOM(atom_name);
+    }
     g_event_window = XCreateSimpleWindow(g_display, g_root, 42, 42, 42, 42, 0, 0, 0);
     // set wm_class for window
     XClassHint *hint = XAllocClassHint();
@@ -42,16 +52,68 @@ void hook_destroy() {
     XDestroyWindow(g_display, g_event_window);
 }
 
+static bool hook_equals(char** hook, int argc, const char** argv) {
+    for (int i = 0; i < argc; i++) {
+        if (!hook[i] || strcmp(hook[i], argv[i])) {
+            return false;
+        }
+    }
+    return hook[argc] == NULL;
+}
+
+// remembers the hook until the batch ends. If an equal hook is already
+// pending, then it is moved to the end of the queue instead of being emitted
+// a second time, such that the order of the last occurrences is kept.
+static void hook_defer(int argc, const char** argv) {
+    for (GList* cur = g_pending_hooks.head; cur; cur = cur->next) {
+        if (hook_equals((char**)cur->data, argc, argv)) {
+            g_queue_unlink(&g_pending_hooks, cur);
+            g_queue_push_tail_link(&g_pending_hooks, cur);
+            return;
+        }
+    }
+    char** hook = g_new(char*, argc + 1);
+    for (int i = 0; i < argc; i++) {
+        hook[i] = g_strdup(argv[i]);
+    }
+    hook[argc] = NULL;
+    g_queue_push_tail(&g_pending_hooks, hook);
+}
+
+void hook_batch_begin() {
+    g_hook_batch_depth++;
+}
+
+void hook_batch_end() {
+    HSAssert(g_hook_batch_depth > 0);
+    if (--g_hook_batch_depth > 0) {
+        return;
+    }
+    char** hook;
+    while ((hook = (char**)g_queue_pop_head(&g_pending_hooks))) {
+        int argc = 0;
+        while (hook[argc]) {
+            argc++;
+        }
+        hook_emit(argc, (const char**)hook);
+        g_strfreev(hook);
+    }
+}
+
 void hook_emit(int argc, const char** argv) {
     static int last_property_number = 0;
     if (argc <= 0) {
         // nothing to do
         return;
     }
+    // every hook announces some change of the state
+    state_changed();
+    if (g_hook_batch_depth > 0) {
+        hook_defer(argc, argv);
+        return;
+    }
     XTextProperty text_prop;
-    static char atom_name[STRING_BUF_SIZE];
-    snprintf(atom_name, STRING_BUF_SIZE, HERBST_HOOK_PROPERTY_FORMAT, last_property_number);
-    Atom atom = ATOM(atom_name);
+    Atom atom = g_hook_atoms[last_property_number];
     Xutf8TextListToTextProperty(g_display, (char**)argv, argc, XUTF8StringStyle, &text_prop);
     XSetTextProperty(g_display, g_event_window, &text_prop, atom);
     XFree(text_prop.value);
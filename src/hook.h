@@ -11,6 +11,11 @@
 void hook_init();
 void hook_destroy();
 
+// while a batch is open, hooks are collected and emitted when the
+// outermost batch ends
+void hook_batch_begin();
+void hook_batch_end();
+
 void hook_emit(int argc, const char** argv);
 void emit_tag_changed(HSTag* tag, int monitor);
 void hook_emit_list(const char* name, ...);
@@ -6,6 +6,7 @@
 #include "globals.h"
 #include "command.h"
 #include "utils.h"
+#include "x11-utils.h"
 #include "ipc-protocol.h"
 #include "ipc-server.h"
 
@@ -34,7 +35,8 @@ void ipc_add_connection(Window window) {
 
 bool ipc_handle_connection(Window win) {
     XTextProperty text_prop;
-    if (!XGetTextProperty(g_display, win, &text_prop, ATOM(HERBST_IPC_ARGS_ATOM))) {
+    if (!X11_ROUND_TRIP(XGetTextProperty(g_display, win, &text_prop,
+                                         ATOM(HERBST_IPC_ARGS_ATOM)))) {
         // if the args atom is not present any more then it already has been
         // executed (e.g. after being called by ipc_add_connection())
         return false;
@@ -68,7 +70,7 @@ bool ipc_handle_connection(Window win) {
 
 bool is_ipc_connectable(Window window) {
     XClassHint hint;
-    if (0 == XGetClassHint(g_display, window, &hint)) {
+    if (0 == X11_ROUND_TRIP(XGetClassHint(g_display, window, &hint))) {
         return false;
     }
     bool is_ipc = false;
@@ -6,8 +6,10 @@
 #include "key.h"
 #include "globals.h"
 #include "utils.h"
+#include "x11-utils.h"
 #include "ipc-protocol.h"
 #include "command.h"
+#include "trie.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -24,13 +26,21 @@ unsigned int* get_numlockmask_ptr() {
 }
 
 static GList* g_key_binds = NULL;
+static HSTrie* g_keysym_names = NULL;   // keysym name -> non-NULL
+static HSTrie* g_modifier_trie = NULL;  // modifier name -> Name2Modifier*
+
+static void init_modifier_trie();
 
 void key_init() {
     update_numlockmask();
+    init_modifier_trie();
+    update_keysym_trie();
 }
 
 void key_destroy() {
     key_remove_all_binds();
+    trie_destroy(g_keysym_names);
+    trie_destroy(g_modifier_trie);
 }
 
 void key_remove_all_binds() {
@@ -62,6 +72,14 @@ static Name2Modifier g_modifier_names[] = {
     { "Ctrl",       ControlMask },
 };
 
+static void init_modifier_trie() {
+    g_modifier_trie = trie_create();
+    for (int i = 0; i < LENGTH(g_modifier_names); i++) {
+        trie_insert(g_modifier_trie, g_modifier_names[i].name,
+                    g_modifier_names + i);
+    }
+}
+
 unsigned int modifiername2mask(const char* name) {
     Name2Modifier* elem;
     elem = STATIC_TABLE_FIND_STR(Name2Modifier, g_modifier_names, name,
@@ -265,7 +283,7 @@ void update_numlockmask() {
     XModifierKeymap *modmap;
 
     numlockmask = 0;
-    modmap = XGetModifierMapping(g_display);
+    modmap = X11_ROUND_TRIP(XGetModifierMapping(g_display));
     for(i = 0; i < 8; i++)
         for(j = 0; j < modmap->max_keypermod; j++)
             if(modmap->modifiermap[i * modmap->max_keypermod + j]
@@ -349,34 +367,74 @@ int key_list_binds(int argc, char** argv, GString* output) {
     return 0;
 }
 
-void complete_against_keysyms(const char* needle, char* prefix, GString* output) {
+// rebuilds the set of keysym names used for completion, must be called
+// whenever the keyboard mapping changes
+void update_keysym_trie() {
+    if (!g_keysym_names) {
+        g_keysym_names = trie_create();
+    }
+    trie_clear(g_keysym_names);
     // get all possible keysyms
     int min, max;
     XDisplayKeycodes(g_display, &min, &max);
     int kc_count = max - min + 1;
     int ks_per_kc; // count of keysysms per keycode
     KeySym* keysyms;
-    keysyms = XGetKeyboardMapping(g_display, min, kc_count, &ks_per_kc);
+    keysyms = X11_ROUND_TRIP(XGetKeyboardMapping(g_display, min, kc_count, &ks_per_kc));
     // only symbols at a position i*ks_per_kc are symbols that are recieved in
     // a keyevent, it should be the symbol for the keycode if no modifier is
     // pressed
     for (int i = 0; i < kc_count; i++) {
         if (keysyms[i * ks_per_kc] != NoSymbol) {
             char* str = XKeysymToString(keysyms[i * ks_per_kc]);
-            try_complete_prefix(needle, str, prefix, output);
+            if (str) {
+                trie_insert(g_keysym_names, str, GINT_TO_POINTER(1));
+            }
         }
     }
     XFree(keysyms);
 }
 
+struct KeyCompletion {
+    const char* needle;
+    const char* prefix;
+    char        separator;
+    GString*    buf;
+    GString*    output;
+};
+
+static void complete_against_keysyms_helper(const char* key, void* data,
+                                            void* user_data) {
+    struct KeyCompletion* c = (struct KeyCompletion*) user_data;
+    try_complete_prefix(c->needle, key, c->prefix, c->output);
+}
+
+void complete_against_keysyms(const char* needle, char* prefix, GString* output) {
+    struct KeyCompletion data = { needle, prefix, '\0', NULL, output };
+    trie_foreach_prefix(g_keysym_names, needle,
+                        complete_against_keysyms_helper, &data);
+}
+
+static void complete_against_modifiers_helper(const char* key, void* data,
+                                              void* user_data) {
+    struct KeyCompletion* c = (struct KeyCompletion*) user_data;
+    g_string_printf(c->buf, "%s%c", key, c->separator);
+    try_complete_prefix_partial(c->needle, c->buf->str, c->prefix, c->output);
+}
+
 void complete_against_modifiers(const char* needle, char seperator,
                                 char* prefix, GString* output) {
-    GString* buf = g_string_sized_new(20);
-    for (int i = 0; i < LENGTH(g_modifier_names); i++) {
-        g_string_printf(buf, "%s%c", g_modifier_names[i].name, seperator);
-        try_complete_prefix_partial(needle, buf->str, prefix, output);
-    }
-    g_string_free(buf, true);
+    struct KeyCompletion data = {
+        needle, prefix, seperator, g_string_sized_new(20), output
+    };
+    // a needle like "Mod4+" may already contain the separator, so only
+    // the part before it can be used to narrow down the candidates
+    GString* lookup = g_string_new(needle);
+    g_string_truncate(lookup, strcspn(lookup->str, KEY_COMBI_SEPARATORS));
+    trie_foreach_prefix(g_modifier_trie, lookup->str,
+                        complete_against_modifiers_helper, &data);
+    g_string_free(lookup, true);
+    g_string_free(data.buf, true);
 }
 
 static void key_set_keymask_helper(KeyBinding* b, regex_t *keymask_regex) {
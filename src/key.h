@@ -39,6 +39,7 @@ void key_find_binds(const char* needle, GString* output);
 void complete_against_modifiers(const char* needle, char seperator,
                                 char* prefix, GString* output);
 void complete_against_keysyms(const char* needle, char* prefix, GString* output);
+void update_keysym_trie();
 void regrab_keys();
 void grab_keybind(KeyBinding* binding, void* useless_pointer);
 void update_numlockmask();
@@ -0,0 +1,181 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#include "layout-engine.h"
+
+const char* g_layout_names[LAYOUT_COUNT + 1] = {
+    "vertical",
+    "horizontal",
+    "max",
+    "grid",
+    NULL,
+};
+
+// places the clients next to each other, either below each other (vertical)
+// or side by side
+template<bool vertical>
+static void layout_linear(Rectangle rect, const HSLayoutParams* params,
+                          Rectangle* out) {
+    int count = (int) params->count;
+    if (count == 0) {
+        return;
+    }
+    Rectangle cur = rect;
+    // the space that remains if count does not divide the frame size
+    int last_step;
+    if (vertical) {
+        last_step = cur.height % count;
+        cur.height /= count;
+    } else {
+        last_step = cur.width % count;
+        cur.width /= count;
+    }
+    for (int i = 0; i < count; i++) {
+        out[i] = cur;
+        if (vertical) {
+            cur.y += cur.height;
+        } else {
+            cur.x += cur.width;
+        }
+    }
+    // give the remaining space to the last client
+    if (vertical) {
+        out[count - 1].height += last_step;
+    } else {
+        out[count - 1].width += last_step;
+    }
+}
+
+static void layout_max(Rectangle rect, const HSLayoutParams* params,
+                       Rectangle* out) {
+    for (size_t i = 0; i < params->count; i++) {
+        out[i] = rect;
+    }
+}
+
+void layout_grid_get_size(size_t count, int* res_rows, int* res_cols) {
+    int cols = 0;
+    while (cols * cols < count) {
+        cols++;
+    }
+    *res_cols = cols;
+    if (*res_cols != 0) {
+        *res_rows = (count / cols) + (count % cols ? 1 : 0);
+    } else {
+        *res_rows = 0;
+    }
+}
+
+// if gapless is set, then the last client fills the remaining columns of
+// the last row
+template<bool gapless>
+static void layout_grid_cells(Rectangle rect, size_t count, Rectangle* out) {
+    if (count == 0) {
+        return;
+    }
+    int rows, cols;
+    layout_grid_get_size(count, &rows, &cols);
+    int width = rect.width / cols;
+    int height = rect.height / rows;
+    int i = 0;
+    Rectangle cur = rect; // current rectangle
+    for (int r = 0; r < rows; r++) {
+        // reset to left
+        cur.x = rect.x;
+        cur.width = width;
+        cur.height = height;
+        if (r == rows -1) {
+            // fill small pixel gap below last row
+            cur.height += rect.height % rows;
+        }
+        for (int c = 0; c < cols && i < count; c++) {
+            if (gapless && (i == count - 1) // if last client
+                && (count % cols != 0)) {   // if cols remain
+                // fill remaining cols with client
+                cur.width = rect.x + rect.width - cur.x;
+            } else if (c == cols - 1) {
+                // fill small pixel gap in last col
+                cur.width += rect.width % cols;
+            }
+            out[i] = cur;
+            cur.x += width;
+            i++;
+        }
+        cur.y += height;
+    }
+}
+
+static void layout_grid(Rectangle rect, const HSLayoutParams* params,
+                        Rectangle* out) {
+    if (params->gapless_grid) {
+        layout_grid_cells<true>(rect, params->count, out);
+    } else {
+        layout_grid_cells<false>(rect, params->count, out);
+    }
+}
+
+// indexed by the LAYOUT_* values
+static const HSLayoutEngine g_layout_engines[] = {
+    { layout_linear<true>,  false },    // LAYOUT_VERTICAL
+    { layout_linear<false>, false },    // LAYOUT_HORIZONTAL
+    { layout_max,           true  },    // LAYOUT_MAX
+    { layout_grid,          false },    // LAYOUT_GRID
+};
+
+static_assert(sizeof(g_layout_engines) / sizeof(*g_layout_engines)
+              == LAYOUT_COUNT, "each layout needs an engine");
+
+const HSLayoutEngine* layout_engine(int layout) {
+    if (layout < 0 || layout >= LAYOUT_COUNT) {
+        layout = LAYOUT_VERTICAL;
+    }
+    return g_layout_engines + layout;
+}
+
+void layout_split(Rectangle rect, bool vertical, int fraction,
+                  Rectangle* first, Rectangle* second) {
+    *first = rect;
+    *second = rect;
+    if (vertical) {
+        first->height = (rect.height * fraction) / FRACTION_UNIT;
+        second->y += first->height;
+        second->height -= first->height;
+    } else {
+        first->width = (rect.width * fraction) / FRACTION_UNIT;
+        second->x += first->width;
+        second->width -= first->width;
+    }
+}
+
+Rectangle layout_frame_inner_rect(Rectangle rect, int frame_gap,
+                                  int border_width) {
+    // apply frame gap
+    rect.height -= frame_gap;
+    rect.width -= frame_gap;
+    // apply frame border
+    rect.x += border_width;
+    rect.y += border_width;
+    rect.height -= border_width * 2;
+    rect.width -= border_width * 2;
+    return rect;
+}
+
+Rectangle layout_client_area(Rectangle rect, int window_gap, int padding) {
+    // apply window gap
+    rect.x += window_gap;
+    rect.y += window_gap;
+    rect.width -= window_gap;
+    rect.height -= window_gap;
+    // apply frame padding
+    rect.x += padding;
+    rect.y += padding;
+    rect.width  -= padding * 2;
+    rect.height -= padding * 2;
+    return rect;
+}
+
+bool layout_smart_surroundings(bool enabled, size_t count, int layout) {
+    return enabled && (count == 1 || layout == LAYOUT_MAX);
+}
@@ -0,0 +1,70 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#ifndef __HERBSTLUFT_LAYOUT_ENGINE_H_
+#define __HERBSTLUFT_LAYOUT_ENGINE_H_
+
+#include "x11-types.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+// The client layouts only compute the rectangles of the clients of a frame,
+// they do not send any requests to the X server and do not access any
+// global state. Applying the rectangles to the windows is done by the
+// caller, see frame_apply_layout().
+
+enum {
+    LAYOUT_VERTICAL = 0,
+    LAYOUT_HORIZONTAL,
+    LAYOUT_MAX,
+    LAYOUT_GRID,
+    LAYOUT_COUNT,
+};
+
+extern const char* g_layout_names[LAYOUT_COUNT + 1];
+
+#define FRACTION_UNIT 10000
+
+typedef struct {
+    size_t  count;          // number of clients
+    int     selection;      // index of the selected client
+    bool    gapless_grid;   // value of the setting gapless_grid
+} HSLayoutParams;
+
+// computes the rectangles of the params->count clients within rect and
+// writes them to out, which must have space for params->count rectangles
+typedef void (*HSLayoutFunc)(Rectangle rect, const HSLayoutParams* params,
+                             Rectangle* out);
+
+typedef struct {
+    HSLayoutFunc    compute;
+    // if set, the clients overlap and only the selected one is visible, so
+    // it has to be raised
+    bool            raise_selection;
+} HSLayoutEngine;
+
+// returns the engine for one of the LAYOUT_* values
+const HSLayoutEngine* layout_engine(int layout);
+
+// computes the number of rows and columns of a grid with count cells
+void layout_grid_get_size(size_t count, int* res_rows, int* res_cols);
+
+// splits rect into first and second, such that first gets the given
+// fraction of rect. If vertical is set, then first is above second.
+void layout_split(Rectangle rect, bool vertical, int fraction,
+                  Rectangle* first, Rectangle* second);
+// returns the rect of a frame window without the frame gap and its border
+Rectangle layout_frame_inner_rect(Rectangle rect, int frame_gap,
+                                  int border_width);
+// returns the area for the clients of a frame window, i.e. without the
+// window gap and the frame padding
+Rectangle layout_client_area(Rectangle rect, int window_gap, int padding);
+// tells if the gaps and borders around the count clients of a frame with the
+// given layout are omitted if the setting smart_window_surroundings is
+// enabled
+bool layout_smart_surroundings(bool enabled, size_t count, int layout);
+
+#endif
+
@@ -12,9 +12,12 @@
 #include "ipc-protocol.h"
 #include "settings.h"
 #include "layout.h"
+#include "history.h"
 #include "stack.h"
 #include "monitor.h"
 #include "floating.h"
+#include "state.h"
+#include "mouse.h"
 
 #include <glib.h>
 #include "glib-backports.h"
@@ -54,6 +57,9 @@ static unsigned long g_frame_bg_active_color;
 static unsigned long g_frame_bg_normal_color;
 static unsigned long g_frame_active_opacity;
 static unsigned long g_frame_normal_opacity;
+// the rectangles computed by the layout engines, reused for all frames
+static Rectangle* g_client_rects;
+static size_t g_client_rects_size;
 
 HSFrame*    g_cur_frame; // currently selected frame
 int* g_frame_gap;
@@ -64,44 +70,36 @@ const char* g_align_names[] = {
     "horizontal",
 };
 
-const char* g_layout_names[] = {
-    "vertical",
-    "horizontal",
-    "max",
-    "grid",
-    NULL,
-};
-
 static void fetch_frame_colors() {
     // load settings
-    g_frame_gap = &(settings_find("frame_gap")->value.i);
-    g_frame_padding = &(settings_find("frame_padding")->value.i);
-    g_window_gap = &(settings_find("window_gap")->value.i);
-    g_frame_border_width = &(settings_find("frame_border_width")->value.i);
-    g_frame_border_inner_width = &(settings_find("frame_border_inner_width")->value.i);
-    g_always_show_frame = &(settings_find("always_show_frame")->value.i);
-    g_frame_bg_transparent = &(settings_find("frame_bg_transparent")->value.i);
-    g_frame_transparent_width = &(settings_find("frame_transparent_width")->value.i);
-    g_default_frame_layout = &(settings_find("default_frame_layout")->value.i);
-    g_direction_external_only = &(settings_find("default_direction_external_only")->value.i);
-    g_gapless_grid = &(settings_find("gapless_grid")->value.i);
-    g_smart_frame_surroundings = &(settings_find("smart_frame_surroundings")->value.i);
-    g_smart_window_surroundings = &(settings_find("smart_window_surroundings")->value.i);
-    g_focus_crosses_monitor_boundaries = &(settings_find("focus_crosses_monitor_boundaries")->value.i);
+    g_frame_gap = &(settings_by_id(SETTING_FRAME_GAP)->value.i);
+    g_frame_padding = &(settings_by_id(SETTING_FRAME_PADDING)->value.i);
+    g_window_gap = &(settings_by_id(SETTING_WINDOW_GAP)->value.i);
+    g_frame_border_width = &(settings_by_id(SETTING_FRAME_BORDER_WIDTH)->value.i);
+    g_frame_border_inner_width = &(settings_by_id(SETTING_FRAME_BORDER_INNER_WIDTH)->value.i);
+    g_always_show_frame = &(settings_by_id(SETTING_ALWAYS_SHOW_FRAME)->value.i);
+    g_frame_bg_transparent = &(settings_by_id(SETTING_FRAME_BG_TRANSPARENT)->value.i);
+    g_frame_transparent_width = &(settings_by_id(SETTING_FRAME_TRANSPARENT_WIDTH)->value.i);
+    g_default_frame_layout = &(settings_by_id(SETTING_DEFAULT_FRAME_LAYOUT)->value.i);
+    g_direction_external_only = &(settings_by_id(SETTING_DEFAULT_DIRECTION_EXTERNAL_ONLY)->value.i);
+    g_gapless_grid = &(settings_by_id(SETTING_GAPLESS_GRID)->value.i);
+    g_smart_frame_surroundings = &(settings_by_id(SETTING_SMART_FRAME_SURROUNDINGS)->value.i);
+    g_smart_window_surroundings = &(settings_by_id(SETTING_SMART_WINDOW_SURROUNDINGS)->value.i);
+    g_focus_crosses_monitor_boundaries = &(settings_by_id(SETTING_FOCUS_CROSSES_MONITOR_BOUNDARIES)->value.i);
     *g_default_frame_layout = CLAMP(*g_default_frame_layout, 0, LAYOUT_COUNT - 1);
-    char* str = settings_find_string("frame_border_normal_color");
+    char* str = settings_by_id(SETTING_FRAME_BORDER_NORMAL_COLOR)->value.str->str;
     g_frame_border_normal_color = getcolor(str);
-    str = settings_find_string("frame_border_active_color");
+    str = settings_by_id(SETTING_FRAME_BORDER_ACTIVE_COLOR)->value.str->str;
     g_frame_border_active_color = getcolor(str);
-    str = settings_find_string("frame_border_inner_color");
+    str = settings_by_id(SETTING_FRAME_BORDER_INNER_COLOR)->value.str->str;
     g_frame_border_inner_color = getcolor(str);
     // background color
-    str = settings_find_string("frame_bg_normal_color");
+    str = settings_by_id(SETTING_FRAME_BG_NORMAL_COLOR)->value.str->str;
     g_frame_bg_normal_color = getcolor(str);
-    str = settings_find_string("frame_bg_active_color");
+    str = settings_by_id(SETTING_FRAME_BG_ACTIVE_COLOR)->value.str->str;
     g_frame_bg_active_color = getcolor(str);
-    g_frame_active_opacity = CLAMP(settings_find("frame_active_opacity")->value.i, 0, 100);
-    g_frame_normal_opacity = CLAMP(settings_find("frame_normal_opacity")->value.i, 0, 100);
+    g_frame_active_opacity = CLAMP(settings_by_id(SETTING_FRAME_ACTIVE_OPACITY)->value.i, 0, 100);
+    g_frame_normal_opacity = CLAMP(settings_by_id(SETTING_FRAME_NORMAL_OPACITY)->value.i, 0, 100);
 }
 
 void layout_init() {
@@ -113,9 +111,22 @@ void reset_frame_colors() {
 }
 
 void layout_destroy() {
+    g_free(g_client_rects);
+    g_client_rects = NULL;
+    g_client_rects_size = 0;
 }
 
 
+// keeps the client counters of the tag up to date, must be called whenever
+// a client enters (delta = 1) or leaves (delta = -1) a frame of the tag
+static void frame_count_client(HSFrame* frame, HSClient* client, int delta) {
+    state_tag_changed(frame->tag);
+    frame->tag->client_count += delta;
+    if (client->urgent) {
+        frame->tag->urgent_count += delta;
+    }
+}
+
 /* create a new frame
  * you can either specify a frame or a tag as its parent
  */
@@ -126,6 +137,7 @@ HSFrame* frame_create_empty(HSFrame* parent, HSTag* parenttag) {
     frame->content.clients.layout = *g_default_frame_layout;
     frame->parent = parent;
     frame->tag = parent ? parent->tag : parenttag;
+    frame->tag->frame_count++;
     // set window attributes
     XSetWindowAttributes at;
     at.background_pixel  = getcolor("red");
@@ -135,7 +147,7 @@ HSFrame* frame_create_empty(HSFrame* parent, HSTag* parenttag) {
     at.event_mask        = SubstructureRedirectMask|SubstructureNotifyMask
          |ExposureMask|VisibilityChangeMask
          |EnterWindowMask|LeaveWindowMask|FocusChangeMask;
-    frame->window = XCreateWindow(g_display, g_root,
+    frame->window = XCreateWindow(g_display, tag_window_parent(frame->tag),
                         42, 42, 42, 42, *g_frame_border_width,
                         DefaultDepth(g_display, DefaultScreen(g_display)),
                         CopyFromParent,
@@ -170,6 +182,7 @@ void frame_insert_client(HSFrame* frame, struct HSClient* client) {
         // write results back
         frame->content.clients.count = count;
         frame->content.clients.buf = buf;
+        frame_count_client(frame, client, 1);
         // check for focus
         if (g_cur_frame == frame
             && frame->content.clients.selection >= (count-1)) {
@@ -182,6 +195,37 @@ void frame_insert_client(HSFrame* frame, struct HSClient* client) {
     }
 }
 
+void frame_insert_clients(HSFrame* frame, HSClient** clients, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    if (frame->type == TYPE_FRAMES) {
+        HSLayout* layout = &frame->content.layout;
+        frame_insert_clients((layout->selection == 0) ? layout->a : layout->b,
+                             clients, n);
+        return;
+    }
+    HSClient** buf = frame->content.clients.buf;
+    size_t old_count = frame->content.clients.count;
+    size_t count = old_count + n;
+    // insert them after the selection
+    int index = frame->content.clients.selection + 1;
+    index = CLAMP(index, 0, old_count);
+    buf = g_renew(HSClient*, buf, count);
+    memmove(buf + index + n, buf + index, sizeof(*buf) * (old_count - index));
+    memcpy(buf + index, clients, sizeof(*buf) * n);
+    frame->content.clients.count = count;
+    frame->content.clients.buf = buf;
+    for (size_t i = 0; i < n; i++) {
+        frame_count_client(frame, clients[i], 1);
+    }
+    // check for focus
+    if (g_cur_frame == frame && old_count == 0) {
+        frame->content.clients.selection = 0;
+        client_window_focus(buf[0]);
+    }
+}
+
 HSFrame* lookup_frame(HSFrame* root, const char *index) {
     if (index == NULL || index[0] == '\0') return root;
     if (root->type == TYPE_CLIENTS) return root;
@@ -241,6 +285,7 @@ bool frame_remove_client(HSFrame* frame, HSClient* client) {
                 buf = g_renew(HSClient*, buf, count);
                 frame->content.clients.buf = buf;
                 frame->content.clients.count = count;
+                frame_count_client(frame, client, -1);
                 // find out new selection
                 int selection = frame->content.clients.selection;
                 // if selection was before removed window
@@ -261,10 +306,46 @@ bool frame_remove_client(HSFrame* frame, HSClient* client) {
     }
 }
 
+void frame_remove_foreign_clients(HSFrame* frame) {
+    if (frame->type == TYPE_FRAMES) {
+        frame_remove_foreign_clients(frame->content.layout.a);
+        frame_remove_foreign_clients(frame->content.layout.b);
+        return;
+    }
+    HSClient** buf = frame->content.clients.buf;
+    size_t count = frame->content.clients.count;
+    int selection = frame->content.clients.selection;
+    // the selection moves back by the number of removed clients before it,
+    // and by one more if the selected client itself is removed
+    int shift = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (buf[i]->tag == frame->tag) {
+            buf[kept++] = buf[i];
+            continue;
+        }
+        frame_count_client(frame, buf[i], -1);
+        if ((int)i <= selection) {
+            shift++;
+        }
+    }
+    if (kept == count) {
+        return;
+    }
+    frame->content.clients.buf = g_renew(HSClient*, buf, kept);
+    frame->content.clients.count = kept;
+    selection -= shift;
+    frame->content.clients.selection = kept ? CLAMP(selection, 0, kept - 1) : 0;
+}
+
 void frame_destroy(HSFrame* frame, HSClient*** buf, size_t* count) {
     if (frame->type == TYPE_CLIENTS) {
         *buf = frame->content.clients.buf;
         *count = frame->content.clients.count;
+        for (size_t i = 0; i < *count; i++) {
+            frame_count_client(frame, (*buf)[i], -1);
+        }
+        frame->tag->frame_count--;
     } else { /* frame->type == TYPE_FRAMES */
         size_t c1, c2;
         HSClient **buf1, **buf2;
@@ -282,6 +363,7 @@ void frame_destroy(HSFrame* frame, HSClient*** buf, size_t* count) {
     stack_remove_slice(frame->tag->stack, frame->slice);
     slice_destroy(frame->slice);
     // free other things
+    double_border_free(g_display, &frame->border);
     XDestroyWindow(g_display, frame->window);
     g_free(frame);
 }
@@ -319,6 +401,70 @@ void dump_frame_tree(HSFrame* frame, GString* output) {
     }
 }
 
+// turns a frame with subframes into a client frame that contains all the
+// clients of the former subframes
+void frame_collapse(HSFrame* frame) {
+    if (frame->type != TYPE_FRAMES) {
+        return;
+    }
+    // remove childs
+    HSClient **buf1, **buf2;
+    size_t count1, count2;
+    frame_destroy(frame->content.layout.a, &buf1, &count1);
+    frame_destroy(frame->content.layout.b, &buf2, &count2);
+
+    // merge bufs
+    size_t count = count1 + count2;
+    HSClient** buf = g_new(HSClient*, count);
+    memcpy(buf,             buf1, sizeof(buf[0]) * count1);
+    memcpy(buf + count1,    buf2, sizeof(buf[0]) * count2);
+    g_free(buf1);
+    g_free(buf2);
+
+    // setup frame
+    frame->type = TYPE_CLIENTS;
+    frame->content.clients.buf = buf;
+    frame->content.clients.count = count;
+    frame->content.clients.selection = 0; // only some sane defaults
+    frame->content.clients.layout = 0; // only some sane defaults
+    frame->tag->frame_count++;
+    for (size_t i = 0; i < count; i++) {
+        frame_count_client(frame, buf[i], 1);
+    }
+}
+
+// moves a client from wherever it is to the given index of the client frame
+void frame_load_client(HSFrame* frame, HSClient* client, int index) {
+    HSTag* tag = find_tag_with_toplevel_frame(get_toplevel_frame(frame));
+    // remove window from old tag
+    HSMonitor* clientmonitor = find_monitor_with_tag(client->tag);
+    if (!frame_remove_client(client->tag->frame, client)) {
+        g_warning("window %lx was not found on tag %s\n",
+            client->window, client->tag->name->str);
+    }
+    if (clientmonitor) {
+        monitor_apply_layout(clientmonitor);
+    }
+    stack_remove_slice(client->tag->stack, client->slice);
+
+    // insert it to buf
+    HSClient** buf = frame->content.clients.buf;
+    size_t count = frame->content.clients.count;
+    count++;
+    index = CLAMP(index, 0, count - 1);
+    buf = g_renew(HSClient*, buf, count);
+    memmove(buf + index + 1, buf + index,
+            sizeof(buf[0]) * (count - index - 1));
+    buf[index] = client;
+    frame->content.clients.buf = buf;
+    frame->content.clients.count = count;
+    frame_count_client(frame, client, 1);
+
+    client->tag = tag;
+    stack_insert_slice(client->tag->stack, client->slice);
+    ewmh_window_update_tag(client->window, client->tag);
+}
+
 char* load_frame_tree(HSFrame* frame, char* description, GString* errormsg) {
     // find next (
     description = strchr(description, LAYOUT_DUMP_BRACKETS[0]);
@@ -426,34 +572,12 @@ char* load_frame_tree(HSFrame* frame, char* description, GString* errormsg) {
         }
 
         // ensure that it is a client frame
-        if (frame->type == TYPE_FRAMES) {
-            // remove childs
-            HSClient **buf1, **buf2;
-            size_t count1, count2;
-            frame_destroy(frame->content.layout.a, &buf1, &count1);
-            frame_destroy(frame->content.layout.b, &buf2, &count2);
-
-            // merge bufs
-            size_t count = count1 + count2;
-            HSClient** buf = g_new(HSClient*, count);
-            memcpy(buf,             buf1, sizeof(buf[0]) * count1);
-            memcpy(buf + count1,    buf2, sizeof(buf[0]) * count2);
-            g_free(buf1);
-            g_free(buf2);
-
-            // setup frame
-            frame->type = TYPE_CLIENTS;
-            frame->content.clients.buf = buf;
-            frame->content.clients.count = count;
-            frame->content.clients.selection = 0; // only some sane defaults
-            frame->content.clients.layout = 0; // only some sane defaults
-        }
+        frame_collapse(frame);
 
         // bring child wins
         // jump over whitespaces
         description += strspn(description, LAYOUT_DUMP_WHITESPACES);
         int index = 0;
-        HSTag* tag = find_tag_with_toplevel_frame(get_toplevel_frame(frame));
         while (*description != LAYOUT_DUMP_BRACKETS[1]) {
             Window win;
             if (1 != sscanf(description, "0x%lx\n", &win)) {
@@ -471,34 +595,7 @@ char* load_frame_tree(HSFrame* frame, char* description, GString* errormsg) {
                 // client not managed... ignore it
                 continue;
             }
-
-            // remove window from old tag
-            HSMonitor* clientmonitor = find_monitor_with_tag(client->tag);
-            if (!frame_remove_client(client->tag->frame, client)) {
-                g_warning("window %lx was not found on tag %s\n",
-                    win, client->tag->name->str);
-            }
-            if (clientmonitor) {
-                monitor_apply_layout(clientmonitor);
-            }
-            stack_remove_slice(client->tag->stack, client->slice);
-
-            // insert it to buf
-            HSClient** buf = frame->content.clients.buf;
-            size_t count = frame->content.clients.count;
-            count++;
-            index = CLAMP(index, 0, count - 1);
-            buf = g_renew(HSClient*, buf, count);
-            memmove(buf + index + 1, buf + index,
-                    sizeof(buf[0]) * (count - index - 1));
-            buf[index] = client;
-            frame->content.clients.buf = buf;
-            frame->content.clients.count = count;
-
-            client->tag = tag;
-            stack_insert_slice(client->tag->stack, client->slice);
-            ewmh_window_update_tag(client->window, client->tag);
-
+            frame_load_client(frame, client, index);
             index++;
         }
         // apply layout and selection
@@ -575,24 +672,25 @@ static size_t frame_child_count(HSTree tree) {
     return (frame->type == TYPE_CLIENTS) ? 0 : 2;
 }
 
-static HSTreeInterface frame_nth_child(HSTree tree, size_t idx) {
+static void frame_foreach_child(HSTree tree, HSTreeChildAction action,
+                                void* data) {
     HSFrame* frame = (HSFrame*) tree;
     assert(frame->type != TYPE_CLIENTS);
     HSTreeInterface intf = {
-        /* .nth_child  = */ frame_nth_child,
+        /* .foreach_child  = */ frame_foreach_child,
         /* .child_count    = */ frame_child_count,
         /* .append_caption = */ frame_append_caption,
-        /* .data       = */ (idx == 0)
-                        ? frame->content.layout.a
-                        : frame->content.layout.b,
-        /* .destructor = */ NULL,
+        /* .data           = */ frame->content.layout.a,
+        /* .destructor     = */ NULL,
     };
-    return intf;
+    action(&intf, data);
+    intf.data = frame->content.layout.b;
+    action(&intf, data);
 }
 
 void print_frame_tree(HSFrame* frame, GString* output) {
     HSTreeInterface frameintf = {
-        /* .nth_child      = */ frame_nth_child,
+        /* .foreach_child  = */ frame_foreach_child,
         /* .child_count    = */ frame_child_count,
         /* .append_caption = */ frame_append_caption,
         /* .data           = */ (HSTree) frame,
@@ -676,210 +774,103 @@ int frame_current_set_client_layout(int argc, char** argv, GString* output) {
     return 0;
 }
 
-void frame_apply_client_layout_linear(HSFrame* frame, Rectangle rect, bool vertical) {
-    HSClient** buf = frame->content.clients.buf;
-    size_t count = frame->content.clients.count;
-    Rectangle cur = rect;
-    int last_step_y;
-    int last_step_x;
-    int step_y;
-    int step_x;
-    if (vertical) {
-        // only do steps in y direction
-        last_step_y = cur.height % count; // get the space on bottom
-        last_step_x = 0;
-        cur.height /= count;
-        step_y = cur.height;
-        step_x = 0;
-    } else {
-        // only do steps in x direction
-        last_step_y = 0;
-        last_step_x = cur.width % count; // get the space on the right
-        cur.width /= count;
-        step_y = 0;
-        step_x = cur.width;
-    }
-    for (int i = 0; i < count; i++) {
-        HSClient* client = buf[i];
-        // add the space, if count does not divide frameheight without remainder
-        cur.height += (i == count-1) ? last_step_y : 0;
-        cur.width += (i == count-1) ? last_step_x : 0;
-        client_resize_tiling(client, cur, frame);
-        cur.y += step_y;
-        cur.x += step_x;
-    }
-}
-
-void frame_apply_client_layout_horizontal(HSFrame* frame, Rectangle rect) {
-    frame_apply_client_layout_linear(frame, rect, false);
-}
-
-void frame_apply_client_layout_vertical(HSFrame* frame, Rectangle rect) {
-    frame_apply_client_layout_linear(frame, rect, true);
-}
-
-void frame_apply_client_layout_max(HSFrame* frame, Rectangle rect) {
+// computes the rectangles of the clients of frame with its layout engine and
+// then applies them to the client windows
+static void frame_apply_client_layout(HSFrame* frame, Rectangle rect) {
     HSClient** buf = frame->content.clients.buf;
     size_t count = frame->content.clients.count;
     int selection = frame->content.clients.selection;
-    for (int i = 0; i < count; i++) {
-        HSClient* client = buf[i];
-        client_setup_border(client, (g_cur_frame == frame) && (i == selection));
-        client_resize_tiling(client, rect, frame);
-        if (i == selection) {
-            client_raise(client);
-        }
-    }
-}
-
-void frame_layout_grid_get_size(size_t count, int* res_rows, int* res_cols) {
-    int cols = 0;
-    while (cols * cols < count) {
-        cols++;
-    }
-    *res_cols = cols;
-    if (*res_cols != 0) {
-        *res_rows = (count / cols) + (count % cols ? 1 : 0);
+    const HSLayoutEngine* engine =
+        layout_engine(frame->content.clients.layout);
+    if (g_client_rects_size < count) {
+        g_client_rects_size = MAX(count, 2 * g_client_rects_size);
+        g_client_rects = g_renew(Rectangle, g_client_rects, g_client_rects_size);
+    }
+    HSLayoutParams params;
+    params.count = count;
+    params.selection = selection;
+    params.gapless_grid = *g_gapless_grid;
+    engine->compute(rect, &params, g_client_rects);
+    // the decoration scheme follows the focus in client_resize_tiling(),
+    // so no separate border update is needed
+    for (size_t i = 0; i < count; i++) {
+        client_resize_tiling(buf[i], g_client_rects[i], frame);
+    }
+    if (engine->raise_selection && count > 0) {
+        client_raise(buf[selection]);
+    }
+}
+
+// returns the rectangle of the frame window without its border, if frame is
+// laid out in rect, and sets bw to the border width of the frame window
+static Rectangle frame_window_rect(HSFrame* frame, Rectangle rect, int* bw) {
+    *bw = *g_frame_border_width;
+    if (!*g_smart_frame_surroundings || frame->parent) {
+        rect = layout_frame_inner_rect(rect, *g_frame_gap, *bw);
     } else {
-        *res_rows = 0;
+        *bw = 0;
     }
+    rect.width = MAX(WINDOW_MIN_WIDTH, rect.width);
+    rect.height = MAX(WINDOW_MIN_HEIGHT, rect.height);
+    return rect;
 }
 
-void frame_apply_client_layout_grid(HSFrame* frame, Rectangle rect) {
-    HSClient** buf = frame->content.clients.buf;
-    size_t count = frame->content.clients.count;
-    int selection = frame->content.clients.selection;
-    if (count == 0) {
-        return;
-    }
-
-    int rows, cols;
-    frame_layout_grid_get_size(count, &rows, &cols);
-    int width = rect.width / cols;
-    int height = rect.height / rows;
-    int i = 0;
-    Rectangle cur = rect; // current rectangle
-    for (int r = 0; r < rows; r++) {
-        // reset to left
-        cur.x = rect.x;
-        cur.width = width;
-        cur.height = height;
-        if (r == rows -1) {
-            // fill small pixel gap below last row
-            cur.height += rect.height % rows;
-        }
-        for (int c = 0; c < cols && i < count; c++) {
-            if (*g_gapless_grid && (i == count - 1) // if last client
-                && (count % cols != 0)) {           // if cols remain
-                // fill remaining cols with client
-                cur.width = rect.x + rect.width - cur.x;
-            } else if (c == cols - 1) {
-                // fill small pixel gap in last col
-                cur.width += rect.width % cols;
-            }
-
-            // apply size
-            HSClient* client = buf[i];
-            client_setup_border(client, (g_cur_frame == frame) && (i == selection));
-            client_resize_tiling(client, cur, frame);
-            cur.x += width;
-            i++;
-        }
-        cur.y += height;
-    }
-
+// sets everything of the frame window that depends on whether it is focused
+static void frame_update_colors(HSFrame* frame, Rectangle rect, int bw) {
+    bool focused = (g_cur_frame == frame);
+    frame_update_border(frame, rect.width, rect.height, bw,
+        focused ? g_frame_border_active_color : g_frame_border_normal_color);
+    XSetWindowBackground(g_display, frame->window,
+        focused ? g_frame_bg_active_color : g_frame_bg_normal_color);
+    ewmh_set_window_opacity(frame->window,
+        (focused ? g_frame_active_opacity : g_frame_normal_opacity) / 100.0);
+    XClearWindow(g_display, frame->window);
 }
 
 void frame_apply_layout(HSFrame* frame, Rectangle rect) {
     frame->last_rect = rect;
     if (frame->type == TYPE_CLIENTS) {
         size_t count = frame->content.clients.count;
-        if (!*g_smart_frame_surroundings || frame->parent) {
-            // apply frame gap
-            rect.height -= *g_frame_gap;
-            rect.width -= *g_frame_gap;
-            // apply frame border
-            rect.x += *g_frame_border_width;
-            rect.y += *g_frame_border_width;
-            rect.height -= *g_frame_border_width * 2;
-            rect.width -= *g_frame_border_width * 2;
-        }
-
-        rect.width = MAX(WINDOW_MIN_WIDTH, rect.width);
-        rect.height = MAX(WINDOW_MIN_HEIGHT, rect.height);
-
-        unsigned long border_color = g_frame_border_normal_color;
-        unsigned long bg_color = g_frame_bg_normal_color;
-        int bw = *g_frame_border_width;
-        if (g_cur_frame == frame) {
-            border_color = g_frame_border_active_color;
-            bg_color = g_frame_bg_active_color;
-        }
-        if (*g_smart_frame_surroundings && !frame->parent) {
-            bw = 0;
-        }
+        int bw;
+        rect = frame_window_rect(frame, rect, &bw);
         XSetWindowBorderWidth(g_display, frame->window, bw);
         XMoveResizeWindow(g_display, frame->window,
                           rect.x - bw,
                           rect.y - bw,
                           rect.width, rect.height);
 
-        frame_update_border(frame->window, border_color);
-
-        XSetWindowBackground(g_display, frame->window, bg_color);
-        if (*g_frame_bg_transparent) { // != ) {
-            window_cut_rect_hole(frame->window, rect.width, rect.height,
-                                 *g_frame_transparent_width);
+        if (*g_frame_bg_transparent) {
+            // only cut a new hole if the old one does not fit anymore
+            if (!frame->window_transparent
+                || frame->shape_width != rect.width
+                || frame->shape_height != rect.height
+                || frame->shape_framewidth != *g_frame_transparent_width) {
+                window_cut_rect_hole(frame->window, rect.width, rect.height,
+                                     *g_frame_transparent_width);
+                frame->shape_width = rect.width;
+                frame->shape_height = rect.height;
+                frame->shape_framewidth = *g_frame_transparent_width;
+            }
         } else if (frame->window_transparent) {
-            window_make_intransparent(frame->window, rect.width, rect.height);
+            window_make_intransparent(frame->window);
         }
         frame->window_transparent = *g_frame_bg_transparent;
-        if (g_cur_frame == frame) {
-            ewmh_set_window_opacity(frame->window, g_frame_active_opacity/100.0);
-        } else {
-            ewmh_set_window_opacity(frame->window, g_frame_normal_opacity/100.0);
-        }
-        XClearWindow(g_display, frame->window);
+        frame_update_colors(frame, rect, bw);
         // move windows
         if (count == 0) {
             return;
         }
 
         if (!smart_window_surroundings_active(frame)) {
-            // apply window gap
-            rect.x += *g_window_gap;
-            rect.y += *g_window_gap;
-            rect.width -= *g_window_gap;
-            rect.height -= *g_window_gap;
-
-            // apply frame padding
-            rect.x += *g_frame_padding;
-            rect.y += *g_frame_padding;
-            rect.width  -= *g_frame_padding * 2;
-            rect.height -= *g_frame_padding * 2;
+            rect = layout_client_area(rect, *g_window_gap, *g_frame_padding);
         }
 
-        if (frame->content.clients.layout == LAYOUT_MAX) {
-            frame_apply_client_layout_max(frame, rect);
-        } else if (frame->content.clients.layout == LAYOUT_GRID) {
-            frame_apply_client_layout_grid(frame, rect);
-        } else {
-            frame_apply_client_layout_linear(frame, rect,
-                (frame->content.clients.layout == LAYOUT_VERTICAL));
-        }
+        frame_apply_client_layout(frame, rect);
     } else { /* frame->type == TYPE_FRAMES */
         HSLayout* layout = &frame->content.layout;
-        Rectangle first = rect;
-        Rectangle second = rect;
-        if (layout->align == ALIGN_VERTICAL) {
-            first.height = (rect.height * layout->fraction) / FRACTION_UNIT;
-            second.y += first.height;
-            second.height -= first.height;
-        } else { // (layout->align == ALIGN_HORIZONTAL)
-            first.width = (rect.width * layout->fraction) / FRACTION_UNIT;
-            second.x += first.width;
-            second.width -= first.width;
-        }
+        Rectangle first, second;
+        layout_split(rect, layout->align == ALIGN_VERTICAL, layout->fraction,
+                     &first, &second);
         frame_apply_layout(layout->a, first);
         frame_apply_layout(layout->b, second);
     }
@@ -899,6 +890,52 @@ void frame_update_frame_window_visibility(HSFrame* frame) {
     frame_do_recursive(frame, frame_update_frame_window_visibility_helper, 2);
 }
 
+// updates the frame window of a client frame after it got or lost the focus
+static void frame_update_focus(HSFrame* frame, HSMonitor* monitor) {
+    int bw;
+    Rectangle rect = frame_window_rect(frame, frame->last_rect, &bw);
+    frame_update_colors(frame, rect, bw);
+    if (!monitor || (!monitor->lock_frames && !monitor->tag->floating)) {
+        frame_update_frame_window_visibility_helper(frame);
+    }
+}
+
+void frame_focus_changed(HSFrame* old_frame, HSClient* old_client) {
+    HSMonitor* monitor = get_current_monitor();
+    HSFrame* new_frame = frame_current_selection_below(monitor->tag->frame);
+    HSClient* new_client = frame_focused_client(new_frame);
+    bool floating = monitor->tag->floating;
+    // the cases in which windows may be moved, resized or hidden
+    bool relayout = monitors_are_locked() || monitor->dirty
+        || (!floating && old_frame == new_frame && old_client != new_client
+            && new_frame->content.clients.layout == LAYOUT_MAX)
+        || (!floating && old_client && old_client->pseudotile)
+        || (!floating && new_client && new_client->pseudotile);
+    if (relayout) {
+        monitor_apply_layout(monitor);
+        return;
+    }
+    // the selections of the frames are part of the tag state
+    state_tag_changed(monitor->tag);
+    // without a relayout, drop_enternotify_events() is not called, so the
+    // pending focus follows mouse has to be cancelled here
+    mouse_focus_cancel();
+    // sets the input focus, the focus layer and the ewmh properties
+    frame_focus_recursive(monitor->tag->frame);
+    if (old_client != new_client) {
+        if (old_client) {
+            client_setup_border(old_client, false);
+        }
+        if (new_client) {
+            client_setup_border(new_client, true);
+        }
+    }
+    if (old_frame != new_frame) {
+        frame_update_focus(old_frame, find_monitor_with_tag(old_frame->tag));
+        frame_update_focus(new_frame, monitor);
+    }
+}
+
 HSFrame* frame_current_selection_below(HSFrame* frame) {
     while (frame->type == TYPE_FRAMES) {
         frame = (frame->content.layout.selection == 0) ?
@@ -958,9 +995,9 @@ int frame_current_set_selection(int argc, char** argv) {
     if (index < 0 || index >= frame->content.clients.count) {
         index = frame->content.clients.count - 1;
     }
+    HSClient* old_client = frame_focused_client(frame);
     frame->content.clients.selection = index;
-    HSClient* client = frame->content.clients.buf[index];
-    client_window_focus(client);
+    frame_focus_changed(frame, old_client);
     return 0;
 }
 
@@ -983,8 +1020,9 @@ int frame_current_cycle_selection(int argc, char** argv) {
     index %= count;
     index += count;
     index %= count;
+    HSClient* old_client = frame_focused_client(frame);
     frame->content.clients.selection = index;
-    monitor_apply_layout(get_current_monitor());
+    frame_focus_changed(frame, old_client);
     return 0;
 }
 
@@ -1007,6 +1045,7 @@ int cycle_all_command(int argc, char** argv) {
     }
     // find current selection
     HSFrame* frame = frame_current_selection();
+    HSClient* old_client = frame_focused_client(frame);
     int index = frame->content.clients.selection;
     bool change_frame = false;
     int direction;
@@ -1042,7 +1081,9 @@ int cycle_all_command(int argc, char** argv) {
     if (c) {
         client_raise(c);
     }
-    monitor_apply_layout(get_current_monitor());
+    if (!change_frame) {
+        frame_focus_changed(frame, old_client);
+    }
     return 0;
 }
 
@@ -1064,6 +1105,10 @@ int cycle_frame_command(int argc, char** argv) {
 //  skip_invisible: if set, don't touch the selection in frames in max layout
 void cycle_frame(int direction, int new_window_index, bool skip_invisible) {
     HSFrame* frame = frame_current_selection();
+    HSFrame* old_frame = frame;
+    HSClient* old_client = frame_focused_client(frame);
+    // whether the visible window of a frame in max layout changes
+    bool relayout = false;
     int other_direction = 1 - direction;
     if (true) {
         HSFrame* top_frame;
@@ -1156,11 +1201,14 @@ void cycle_frame(int direction, int new_window_index, bool skip_invisible) {
             if (!skip_invisible
                 || frame->content.clients.layout != LAYOUT_MAX)
             {
+                int selection = frame->content.clients.selection;
                 frame->content.clients.selection = new_window_index;
                 // ensure it is a valid index
                 size_t count = frame->content.clients.count;
                 frame->content.clients.selection += count;
                 frame->content.clients.selection %= count;
+                relayout = frame->content.clients.layout == LAYOUT_MAX
+                    && frame->content.clients.selection != selection;
             }
         }
 
@@ -1169,7 +1217,11 @@ void cycle_frame(int direction, int new_window_index, bool skip_invisible) {
         frame_focus_recursive(top_frame);
 
     }
-    monitor_apply_layout(get_current_monitor());
+    if (relayout) {
+        monitor_apply_layout(get_current_monitor());
+    } else {
+        frame_focus_changed(old_frame, old_client);
+    }
     return;
 }
 
@@ -1205,6 +1257,7 @@ bool frame_split(HSFrame* frame, int align, int fraction) {
     first->type = frame->type;
     second->type = TYPE_CLIENTS;
     frame->type = TYPE_FRAMES;
+    frame->tag->frame_count--;
     frame->content.layout.align = align;
     frame->content.layout.a = first;
     frame->content.layout.b = second;
@@ -1264,6 +1317,7 @@ int frame_split_command(int argc, char** argv, GString* output) {
     }
     HSFrame* frame = frame_current_selection();
     if (!frame) return 0; // nothing to do
+    HSFrameSnapshot* before = history_begin(frame->tag);
     bool exploding = align == ALIGN_EXPLODE;
     int layout = frame->content.clients.layout;
     int windowcount = frame->content.clients.count;
@@ -1288,6 +1342,7 @@ int frame_split_command(int argc, char** argv, GString* output) {
         }
     }
     if (!frame_split(frame, align, fraction)) {
+        history_commit(frame->tag, before);
         return 0;
     }
     if (exploding) {
@@ -1326,6 +1381,7 @@ int frame_split_command(int argc, char** argv, GString* output) {
     g_cur_frame = frame_current_selection();
     // redraw monitor
     monitor_apply_layout(get_current_monitor());
+    history_commit(frame->tag, before);
     return 0;
 }
 
@@ -1371,12 +1427,14 @@ int frame_change_fraction_command(int argc, char** argv, GString* output) {
     HSFrame* parent = neighbour->parent;
     assert(parent != NULL); // if has neighbour, it also must have a parent
     assert(parent->type == TYPE_FRAMES);
+    HSFrameSnapshot* before = history_begin(parent->tag);
     int fraction = parent->content.layout.fraction;
     fraction += delta;
     fraction = CLAMP(fraction, (int)(FRAME_MIN_FRACTION * FRACTION_UNIT), (int)((1.0 - FRAME_MIN_FRACTION) * FRACTION_UNIT));
     parent->content.layout.fraction = fraction;
     // arrange monitor
     monitor_apply_layout(get_current_monitor());
+    history_commit(parent->tag, before);
     return 0;
 }
 
@@ -1455,7 +1513,7 @@ int frame_inner_neighbour_index(HSFrame* frame, char direction) {
         case LAYOUT_MAX:
             break;
         case LAYOUT_GRID: {
-            frame_layout_grid_get_size(count, &rows, &cols);
+            layout_grid_get_size(count, &rows, &cols);
             if (cols == 0) break;
             int r = selection / cols;
             int c = selection % cols;
@@ -1501,7 +1559,8 @@ int frame_focus_command(int argc, char** argv, GString* output) {
         external_only = true;
         direction = argv[2][0];
     }
-    //HSFrame* frame = g_cur_frame;
+    HSFrame* old_frame = g_cur_frame;
+    HSClient* old_client = frame_focused_client(old_frame);
     int index;
     bool neighbour_found = true;
     if (g_cur_frame->tag->floating) {
@@ -1511,8 +1570,7 @@ int frame_focus_command(int argc, char** argv, GString* output) {
     } else if (!external_only &&
         (index = frame_inner_neighbour_index(g_cur_frame, direction)) != -1) {
         g_cur_frame->content.clients.selection = index;
-        frame_focus_recursive(g_cur_frame);
-        monitor_apply_layout(get_current_monitor());
+        frame_focus_changed(old_frame, old_client);
     } else {
         HSFrame* neighbour = frame_neighbour(g_cur_frame, direction);
         if (neighbour != NULL) { // if neighbour was found
@@ -1522,8 +1580,7 @@ int frame_focus_command(int argc, char** argv, GString* output) {
             selection = (selection == 1) ? 0 : 1;
             parent->content.layout.selection = selection;
             // change focus if possible
-            frame_focus_recursive(parent);
-            monitor_apply_layout(get_current_monitor());
+            frame_focus_changed(old_frame, old_client);
         } else {
             neighbour_found = false;
         }
@@ -1578,6 +1635,8 @@ int frame_move_window_command(int argc, char** argv, GString* output) {
     int index;
     if (!external_only &&
         (index = frame_inner_neighbour_index(g_cur_frame, direction)) != -1) {
+        HSTag* tag = g_cur_frame->tag;
+        HSFrameSnapshot* before = history_begin(tag);
         int selection = g_cur_frame->content.clients.selection;
         HSClient** buf = g_cur_frame->content.clients.buf;
         // if internal neighbour was found, then swap
@@ -1588,10 +1647,13 @@ int frame_move_window_command(int argc, char** argv, GString* output) {
         g_cur_frame->content.clients.selection = index;
         frame_focus_recursive(g_cur_frame);
         monitor_apply_layout(get_current_monitor());
+        history_commit(tag, before);
     } else {
         HSFrame* neighbour = frame_neighbour(g_cur_frame, direction);
         HSClient* client = frame_focused_client(g_cur_frame);
         if (client && neighbour != NULL) { // if neighbour was found
+            HSTag* tag = g_cur_frame->tag;
+            HSFrameSnapshot* before = history_begin(tag);
             // move window to neighbour
             frame_remove_client(g_cur_frame, client);
             frame_insert_client(neighbour, client);
@@ -1617,6 +1679,7 @@ int frame_move_window_command(int argc, char** argv, GString* output) {
 
             // layout was changed, so update it
             monitor_apply_layout(get_current_monitor());
+            history_commit(tag, before);
         } else {
             g_string_append_printf(output,
                 "%s: No neighbour found\n", argv[0]);
@@ -1709,6 +1772,9 @@ bool focus_client(struct HSClient* client, bool switch_tag, bool switch_monitor)
     if (monitor == NULL && !switch_tag) {
         return false;
     }
+    // the focus follows the mouse only until the focus is changed otherwise.
+    // mouse_focus_flush() forgets its target before calling focus_client()
+    mouse_focus_cancel();
     if (monitor != cur_mon && monitor != NULL) {
         if (!switch_monitor) {
             return false;
@@ -1719,6 +1785,24 @@ bool focus_client(struct HSClient* client, bool switch_tag, bool switch_monitor)
             assert(cur_mon == monitor);
         }
     }
+    if (cur_mon->tag == tag) {
+        // only the focus changes, so the windows stay where they are
+        HSFrame* old_frame = g_cur_frame;
+        HSClient* old_client = frame_focused_client(old_frame);
+        // if the selection of a max frame changes, another client has to be
+        // raised, which needs a relayout (as in cycle_frame)
+        HSFrame* target = find_frame_with_client(tag->frame, client);
+        int selection = target ? target->content.clients.selection : 0;
+        bool found = frame_focus_client(tag->frame, client);
+        if (target && !tag->floating
+            && target->content.clients.layout == LAYOUT_MAX
+            && target->content.clients.selection != selection) {
+            monitor_apply_layout(cur_mon);
+        } else {
+            frame_focus_changed(old_frame, old_client);
+        }
+        return found;
+    }
     monitors_lock();
     monitor_set_tag(cur_mon, tag);
     cur_mon = get_current_monitor();
@@ -1807,6 +1891,9 @@ static void frame_hide(HSFrame* frame) {
 void frame_hide_recursive(HSFrame* frame) {
     // first hide children => order = 2
     frame_do_recursive(frame, frame_hide, 2);
+    if (!frame->parent) {
+        tag_container_set_visible(frame->tag, false);
+    }
 }
 
 static void frame_show_clients(HSFrame* frame) {
@@ -1823,6 +1910,9 @@ static void frame_show_clients(HSFrame* frame) {
 void frame_show_recursive(HSFrame* frame) {
     // first show parents, then children => order = 0
     frame_do_recursive(frame, frame_show_clients, 2);
+    if (!frame->parent) {
+        tag_container_set_visible(frame->tag, true);
+    }
 }
 
 static void frame_rotate(HSFrame* frame) {
@@ -1845,8 +1935,11 @@ static void frame_rotate(HSFrame* frame) {
 }
 
 int layout_rotate_command() {
-    frame_do_recursive(get_current_monitor()->tag->frame, frame_rotate, -1);
+    HSTag* tag = get_current_monitor()->tag;
+    HSFrameSnapshot* before = history_begin(tag);
+    frame_do_recursive(tag->frame, frame_rotate, -1);
     monitor_apply_layout(get_current_monitor());
+    history_commit(tag, before);
     return 0;
 }
 
@@ -1856,6 +1949,8 @@ int frame_remove_command(int argc, char** argv) {
         return 0;
     }
     assert(g_cur_frame->type == TYPE_CLIENTS);
+    HSTag* tag = g_cur_frame->tag;
+    HSFrameSnapshot* before = history_begin(tag);
     HSFrame* parent = g_cur_frame->parent;
     HSFrame* first = g_cur_frame;
     HSFrame* second;
@@ -1875,6 +1970,7 @@ int frame_remove_command(int argc, char** argv) {
         frame_insert_client(second, wins[i]);
     }
     g_free(wins);
+    double_border_free(g_display, &parent->border);
     XDestroyWindow(g_display, parent->window);
     // now do tree magic
     // and make second child the new parent
@@ -1894,6 +1990,7 @@ int frame_remove_command(int argc, char** argv) {
     // re-layout
     frame_focus_recursive(parent);
     monitor_apply_layout(get_current_monitor());
+    history_commit(tag, before);
     return 0;
 }
 
@@ -1970,11 +2067,17 @@ int frame_foreach_client(HSFrame* frame, ClientAction action, void* data) {
     return 0;
 }
 
-void frame_update_border(Window window, unsigned long color) {
-    if (*g_frame_border_inner_width > 0 && *g_frame_border_inner_width < *g_frame_border_width) {
-        set_window_double_border(g_display, window, *g_frame_border_inner_width, g_frame_border_inner_color, color);
+void frame_update_border(HSFrame* frame, int width, int height, int bw,
+                         unsigned long color) {
+    if (*g_frame_border_inner_width > 0 && *g_frame_border_inner_width < bw) {
+        set_window_double_border(g_display, frame->window, &frame->border,
+                                 width, height, bw,
+                                 DefaultDepth(g_display, g_screen),
+                                 *g_frame_border_inner_width,
+                                 g_frame_border_inner_color, color);
     } else {
-        XSetWindowBorder(g_display, window, color);
+        double_border_free(g_display, &frame->border);
+        XSetWindowBorder(g_display, frame->window, color);
     }
 }
 
@@ -2005,8 +2108,8 @@ int frame_move_window_edge(int argc, char** argv, GString* output) {
 }
 
 bool smart_window_surroundings_active(HSFrame* frame) {
-    return *g_smart_window_surroundings
-            && (frame->content.clients.count == 1
-                || frame->content.clients.layout == LAYOUT_MAX);
+    return layout_smart_surroundings(*g_smart_window_surroundings,
+                                     frame->content.clients.count,
+                                     frame->content.clients.layout);
 }
 
@@ -14,6 +14,7 @@
 #include "monitor.h"
 #include "tag.h"
 #include "floating.h"
+#include "layout-engine.h"
 
 #define LAYOUT_DUMP_BRACKETS "()" /* must consist of exactly two chars */
 #define LAYOUT_DUMP_WHITESPACES " \t\n" /* must be at least one char */
@@ -35,16 +36,7 @@ enum {
     ALIGN_EXPLODE,
 };
 
-enum {
-    LAYOUT_VERTICAL = 0,
-    LAYOUT_HORIZONTAL,
-    LAYOUT_MAX,
-    LAYOUT_GRID,
-    LAYOUT_COUNT,
-};
-
 extern const char* g_align_names[];
-extern const char* g_layout_names[];
 
 enum {
     TYPE_CLIENTS = 0,
@@ -56,8 +48,6 @@ enum {
 struct HSClient;
 typedef int (*ClientAction)(struct HSClient*, void* data);
 
-#define FRACTION_UNIT 10000
-
 struct HSFrame;
 struct HSSlice;
 struct HSTag;
@@ -90,6 +80,11 @@ typedef struct HSFrame {
     int    window_transparent;
     bool   window_visible;
     Rectangle  last_rect; // last rectangle when being drawn
+    HSDoubleBorder border; // cached border pixmap of window
+    // the geometry the hole in the transparent window was cut for
+    int    shape_width;
+    int    shape_height;
+    int    shape_framewidth;
 } HSFrame;
 
 
@@ -104,6 +99,8 @@ void layout_destroy();
 // for frames
 HSFrame* frame_create_empty(HSFrame* parent, HSTag* parenttag);
 void frame_insert_client(HSFrame* frame, struct HSClient* client);
+// inserts all clients at once, in the given order
+void frame_insert_clients(HSFrame* frame, struct HSClient** clients, size_t count);
 HSFrame* lookup_frame(HSFrame* root, const char* path);
 HSFrame* frame_current_selection();
 HSFrame* frame_current_selection_below(HSFrame* frame);
@@ -112,6 +109,8 @@ HSFrame* find_frame_with_client(HSFrame* frame, struct HSClient* client);
 // removes window from a frame/subframes
 // returns true, if window was found. else: false
 bool frame_remove_client(HSFrame* frame, struct HSClient* client);
+// removes all clients whose tag differs from the tag of the frame
+void frame_remove_foreign_clients(HSFrame* frame);
 // destroys a frame and all its childs
 // then all Windows in it are collected and returned
 // YOU have to g_free the resulting window-buf
@@ -132,6 +131,8 @@ void dump_frame_tree(HSFrame* frame, GString* output);
 // returns pointer to string that was not parsed yet
 // or NULL on an error
 char* load_frame_tree(HSFrame* frame, char* description, GString* errormsg);
+void frame_collapse(HSFrame* frame);
+void frame_load_client(HSFrame* frame, struct HSClient* client, int index);
 int find_layout_by_name(char* name);
 int find_align_by_name(char* name);
 
@@ -162,9 +163,6 @@ int layout_rotate_command();
 // returns success or failure
 int frame_foreach_client(HSFrame* frame, ClientAction action, void* data);
 
-void frame_apply_client_layout_linear(HSFrame* frame, Rectangle rect, bool vertical);
-void frame_apply_client_layout_horizontal(HSFrame* frame, Rectangle rect);
-void frame_apply_client_layout_vertical(HSFrame* frame, Rectangle rect);
 int frame_current_cycle_client_layout(int argc, char** argv, GString* output);
 int frame_current_set_client_layout(int argc, char** argv, GString* output);
 int frame_split_count_to_root(HSFrame* frame, int align);
@@ -174,6 +172,10 @@ int frame_split_count_to_root(HSFrame* frame, int align);
 struct HSClient* frame_focused_client(HSFrame* frame);
 bool frame_focus_client(HSFrame* frame, struct HSClient* client);
 bool focus_client(struct HSClient* client, bool switch_tag, bool switch_monitor);
+// updates the decorations, frame windows, stacking and input focus after the
+// focus moved from old_frame and old_client to the selection on the current
+// monitor. The monitor is only laid out again if windows may move.
+void frame_focus_changed(HSFrame* old_frame, struct HSClient* old_client);
 // moves a window to an other frame
 int frame_move_window_command(int argc, char** argv, GString* output);
 /// removes the current frame
@@ -181,7 +183,8 @@ int frame_remove_command(int argc, char** argv);
 int close_or_remove_command(int argc, char** argv);
 int close_and_remove_command(int argc, char** argv);
 void frame_set_visible(HSFrame* frame, bool visible);
-void frame_update_border(Window window, unsigned long color);
+void frame_update_border(HSFrame* frame, int width, int height, int bw,
+                         unsigned long color);
 
 int frame_focus_edge(int argc, char** argv, GString* output);
 int frame_move_window_edge(int argc, char** argv, GString* output);
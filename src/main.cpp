@@ -6,6 +6,7 @@
 // herbstluftwm
 #include "clientlist.h"
 #include "utils.h"
+#include "x11-utils.h"
 #include "key.h"
 #include "layout.h"
 #include "globals.h"
@@ -21,6 +22,10 @@
 #include "object.h"
 #include "decoration.h"
 #include "desktopwindow.h"
+#include "history.h"
+#include "atoms.h"
+#include "state.h"
+#include "stats.h"
 // standard
 #include <string.h>
 #include <stdio.h>
@@ -39,6 +44,7 @@
 #include <X11/Xutil.h>
 #include <X11/Xatom.h>
 #include <X11/cursorfont.h>
+#include <X11/Xlib-xcb.h>
 
 // globals:
 int g_verbose = 0;
@@ -54,6 +60,10 @@ static Bool     g_otherwm;
 static int (*g_xerrorxlib)(Display *, XErrorEvent *);
 static char*    g_autostart_path = NULL; // if not set, then find it in $HOME or $XDG_CONFIG_HOME
 static int*     g_focus_follows_mouse = NULL;
+static int*     g_focus_follows_mouse_delay = NULL;
+// the window entered last and when, see enternotify()
+static Window   g_mouse_focus_target = None;
+static gint64   g_mouse_focus_entered;
 static bool     g_exec_before_quit = false;
 static char**   g_exec_args = NULL;
 static int*     g_raise_on_click = NULL;
@@ -140,6 +150,7 @@ CommandBinding g_commands[] = {
     CMD_BIND(             "shift_to_monitor",shift_to_monitor),
     CMD_BIND_NO_OUTPUT(   "remove",         frame_remove_command),
     CMD_BIND(             "set",            settings_set_command),
+    CMD_BIND(             "set_many",       settings_set_many_command),
     CMD_BIND(             "toggle",         settings_toggle),
     CMD_BIND(             "cycle_value",    settings_cycle_value),
     CMD_BIND_NO_OUTPUT(   "cycle_monitor",  monitor_cycle_command),
@@ -159,6 +170,7 @@ CommandBinding g_commands[] = {
     CMD_BIND(             "move",           tag_move_window_command),
     CMD_BIND_NO_OUTPUT(   "rotate",         layout_rotate_command),
     CMD_BIND(             "move_index",     tag_move_window_by_index_command),
+    CMD_BIND(             "move_windows",   tag_move_windows_command),
     CMD_BIND(             "add_monitor",    add_monitor_command),
     CMD_BIND(             "raise_monitor",  monitor_raise_command),
     CMD_BIND(             "remove_monitor", remove_monitor_command),
@@ -172,8 +184,12 @@ CommandBinding g_commands[] = {
     CMD_BIND(             "list_rules",     rule_print_all_command),
     CMD_BIND(             "layout",         print_layout_command),
     CMD_BIND(             "stack",          print_stack_command),
+    CMD_BIND(             "dump_state",     dump_state_command),
+    CMD_BIND(             "profile",        profile_command),
     CMD_BIND(             "dump",           print_layout_command),
     CMD_BIND(             "load",           load_command),
+    CMD_BIND(             "undo",           history_undo_command),
+    CMD_BIND(             "redo",           history_redo_command),
     CMD_BIND(             "complete",       complete_command),
     CMD_BIND(             "complete_shell", complete_command),
     CMD_BIND_NO_OUTPUT(   "lock",           monitors_lock_command),
@@ -186,6 +202,7 @@ CommandBinding g_commands[] = {
     CMD_BIND(             "and",            command_chain_command),
     CMD_BIND(             "or",             command_chain_command),
     CMD_BIND(             "!",              negate_command),
+    CMD_BIND(             "batch",          batch_command),
     CMD_BIND(             "attr",           attr_command),
     CMD_BIND(             "compare",        compare_command),
     CMD_BIND(             "object_tree",    print_object_tree_command),
@@ -306,6 +323,7 @@ int load_command(int argc, char** argv, GString* output) {
         tag = m->tag;
     }
     assert(tag != NULL);
+    HSFrameSnapshot* before = history_begin(tag);
     char* rest = load_frame_tree(tag->frame, layout_string, output);
     if (output->len > 0) {
         g_string_prepend(output, "load: ");
@@ -322,6 +340,9 @@ int load_command(int argc, char** argv, GString* output) {
     } else {
         frame_hide_recursive(tag->frame);
     }
+    // a partially loaded layout is recorded as well, such that it can be
+    // undone
+    history_commit(tag, before);
     if (!rest) {
         g_string_append_printf(output,
             "%s: Error while parsing!\n", argv[0]);
@@ -622,44 +643,122 @@ void checkotherwm(void) {
 
 // scan for windows and add them to the list of managed clients
 // from dwm.c
+// what scan() needs to know about a window to decide whether to manage it
+typedef struct {
+    bool    exists;
+    bool    override_redirect;
+    bool    viewable;
+    bool    transient;
+} ScanInfo;
+
+/* fetches the ScanInfo and the HSWindowInfo of all the given windows.
+ * Instead of waiting for the replies window by window, all requests are sent
+ * first and then all replies are collected, so this only costs a single round
+ * trip to the X server.
+ */
+static void scan_fetch_info(Window* wins, size_t count, ScanInfo* info,
+                            HSWindowInfo* window_info) {
+    xcb_connection_t* conn = XGetXCBConnection(g_display);
+    xcb_get_window_attributes_cookie_t* attr_cookies =
+        g_new(xcb_get_window_attributes_cookie_t, count);
+    xcb_get_property_cookie_t* transient_cookies =
+        g_new(xcb_get_property_cookie_t, count);
+    for (size_t i = 0; i < count; i++) {
+        attr_cookies[i] = xcb_get_window_attributes(conn, wins[i]);
+        transient_cookies[i] = xcb_get_property(conn, 0, wins[i],
+                                                XCB_ATOM_WM_TRANSIENT_FOR,
+                                                XCB_ATOM_WINDOW, 0, 1);
+    }
+    // the requests above are sent already, so their replies arrive while
+    // waiting for the window info
+    window_info_fetch(wins, count, window_info);
+    for (size_t i = 0; i < count; i++) {
+        xcb_generic_error_t* error = NULL;
+        xcb_get_window_attributes_reply_t* wa =
+            xcb_get_window_attributes_reply(conn, attr_cookies[i], &error);
+        free(error);
+        error = NULL;
+        xcb_get_property_reply_t* transient =
+            xcb_get_property_reply(conn, transient_cookies[i], &error);
+        free(error);
+        info[i].exists = (wa != NULL);
+        info[i].override_redirect = wa && wa->override_redirect;
+        info[i].viewable = wa && wa->map_state == XCB_MAP_STATE_VIEWABLE;
+        info[i].transient = transient
+                            && transient->type == XCB_ATOM_WINDOW
+                            && xcb_get_property_value_length(transient) > 0;
+        free(wa);
+        free(transient);
+    }
+    g_free(attr_cookies);
+    g_free(transient_cookies);
+}
+
 void scan(void) {
-    unsigned int num;
+    gint64 start = get_monotonic_usec();
+    unsigned int num = 0;
     Window d1, d2, *cl, *wins = NULL;
     unsigned long cl_count;
-    XWindowAttributes wa;
+    int managed = 0;
 
     ewmh_get_original_client_list(&cl, &cl_count);
-    if (XQueryTree(g_display, g_root, &d1, &d2, &wins, &num)) {
-        for (int i = 0; i < num; i++) {
-            if(!XGetWindowAttributes(g_display, wins[i], &wa)
-            || wa.override_redirect || XGetTransientForHint(g_display, wins[i], &d1))
-                continue;
-            // only manage mapped windows.. no strange wins like:
-            //      luakit/dbus/(ncurses-)vim
-            // but manage it if it was in the ewmh property _NET_CLIENT_LIST by
-            // the previous window manager
-            // TODO: what would dwm do?
-            if (is_window_mapped(g_display, wins[i])
-                || 0 <= array_find(cl, cl_count, sizeof(Window), wins+i)) {
-                manage_client(wins[i]);
-                XMapWindow(g_display, wins[i]);
-            }
+    if (!XQueryTree(g_display, g_root, &d1, &d2, &wins, &num)) {
+        wins = NULL;
+        num = 0;
+    }
+    // fetch the info for the children of the root window and for the clients
+    // of the previous window manager at once
+    Window* all = g_new(Window, num + cl_count);
+    if (num > 0) {
+        memcpy(all, wins, sizeof(Window) * num);
+    }
+    if (cl_count > 0) {
+        memcpy(all + num, cl, sizeof(Window) * cl_count);
+    }
+    ScanInfo* info = g_new(ScanInfo, num + cl_count);
+    HSWindowInfo* window_info = g_new(HSWindowInfo, num + cl_count);
+    scan_fetch_info(all, num + cl_count, info, window_info);
+    for (int i = 0; i < num; i++) {
+        if (!info[i].exists || info[i].override_redirect || info[i].transient)
+            continue;
+        // only manage mapped windows.. no strange wins like:
+        //      luakit/dbus/(ncurses-)vim
+        // but manage it if it was in the ewmh property _NET_CLIENT_LIST by
+        // the previous window manager
+        // TODO: what would dwm do?
+        if (info[i].viewable
+            || 0 <= array_find(cl, cl_count, sizeof(Window), wins+i)) {
+            manage_client(wins[i], false, window_info + i);
+            XMapWindow(g_display, wins[i]);
+            managed++;
         }
-        if(wins)
-            XFree(wins);
     }
     // ensure every original client is managed again
     for (int i = 0; i < cl_count; i++) {
         if (get_client_from_window(cl[i])) continue;
-        if (!XGetWindowAttributes(g_display, cl[i], &wa)
-            || wa.override_redirect
-            || XGetTransientForHint(g_display, cl[i], &d1))
-        {
+        ScanInfo* ci = info + num + i;
+        if (!ci->exists || ci->override_redirect || ci->transient) {
             continue;
         }
         XReparentWindow(g_display, cl[i], g_root, 0,0);
-        manage_client(cl[i]);
+        // the prefetched position was relative to the old parent
+        window_info[num + i].geometry.x = 0;
+        window_info[num + i].geometry.y = 0;
+        manage_client(cl[i], false, window_info + num + i);
+        managed++;
+    }
+    for (size_t i = 0; i < num + cl_count; i++) {
+        window_info_free(window_info + i);
+    }
+    g_free(window_info);
+    g_free(info);
+    g_free(all);
+    if (wins) {
+        XFree(wins);
     }
+    HSDebug("scan: managed %d of %lu windows in %.1f ms\n",
+            managed, num + cl_count,
+            (get_monotonic_usec() - start) / 1000.0);
 }
 
 void execute_autostart_file() {
@@ -759,8 +858,10 @@ static void sigaction_signal(int signum, void (*handler)(int)) {
 
 static void fetch_settings() {
     // fetch settings only for this main.c file from settings table
-    g_focus_follows_mouse = &(settings_find("focus_follows_mouse")->value.i);
-    g_raise_on_click = &(settings_find("raise_on_click")->value.i);
+    g_focus_follows_mouse = &(settings_by_id(SETTING_FOCUS_FOLLOWS_MOUSE)->value.i);
+    g_focus_follows_mouse_delay =
+        &(settings_by_id(SETTING_FOCUS_FOLLOWS_MOUSE_DELAY)->value.i);
+    g_raise_on_click = &(settings_by_id(SETTING_RAISE_ON_CLICK)->value.i);
 }
 
 HandlerTable g_default_handler;
@@ -789,14 +890,20 @@ static struct {
     void (*init)();
     void (*destroy)();
 } g_modules[] = {
-    { ipc_init,         ipc_destroy         },
     { object_tree_init, object_tree_destroy },
+    // before atoms_init, such that its round trip is accounted
+    { stats_init,       stats_destroy       },
+    { atoms_init,       atoms_destroy       },
+    { ipc_init,         ipc_destroy         },
+    { state_init,       state_destroy       },
     { key_init,         key_destroy         },
     { settings_init,    settings_destroy    },
+    { command_init,     command_destroy     },
     { reload_tree_style,NULL                },
     { floating_init,    floating_destroy    },
     { stacklist_init,   stacklist_destroy   },
     { layout_init,      layout_destroy      },
+    { history_init,     history_destroy     },
     { tag_init,         tag_destroy         },
     { clientlist_init,  clientlist_destroy  },
     { decorations_init, decorations_destroy },
@@ -846,10 +953,12 @@ void configurerequest(XEvent* event) {
 }
 
 void configurenotify(XEvent* event) {
-    if (event->xconfigure.window == g_root &&
-        settings_find("auto_detect_monitors")->value.i) {
-        const char* args[] = { "detect_monitors" };
-        detect_monitors_command(LENGTH(args), args, NULL);
+    // with RandR, the screen changes are handled by the RandR events
+    if (event->xconfigure.window == g_root && !monitors_randr_active()) {
+        g_screen_width = event->xconfigure.width;
+        g_screen_height = event->xconfigure.height;
+        tag_containers_update_size();
+        monitors_detect_later();
     }
     // HSDebug("name is: ConfigureNotify\n");
 }
@@ -869,18 +978,47 @@ void enternotify(XEvent* event) {
     if (!mouse_is_dragging()
         && *g_focus_follows_mouse
         && ce->focus == false) {
-        HSClient* c = get_client_from_window(ce->window);
-        HSFrame* target;
-        if (c && c->tag->floating == false
-              && (target = find_frame_with_client(c->tag->frame, c))
-              && target->content.clients.layout == LAYOUT_MAX
-              && frame_focused_client(target) != c) {
-            // don't allow focus_follows_mouse if another window would be
-            // hidden during that focus change (which only occurs in max layout)
-        } else if (c) {
-            focus_client(c, false, true);
-        }
+        // only remember it, such that only the last window entered in a
+        // batch of events (or within the delay) gets the focus
+        g_mouse_focus_target = ce->window;
+        g_mouse_focus_entered = get_monotonic_usec();
+    }
+}
+
+void mouse_focus_cancel() {
+    g_mouse_focus_target = None;
+}
+
+// returns the microseconds until the focus follows the mouse, or -1 if the
+// mouse did not enter any window
+static gint64 mouse_focus_timeout() {
+    if (g_mouse_focus_target == None) {
+        return -1;
     }
+    gint64 due = g_mouse_focus_entered
+                 + MAX(0, *g_focus_follows_mouse_delay) * 1000;
+    return MAX(0, due - get_monotonic_usec());
+}
+
+static void mouse_focus_flush() {
+    if (g_mouse_focus_target == None || mouse_focus_timeout() > 0) {
+        return;
+    }
+    HSClient* c = get_client_from_window(g_mouse_focus_target);
+    g_mouse_focus_target = None;
+    if (!c || mouse_is_dragging() || !*g_focus_follows_mouse) {
+        return;
+    }
+    HSFrame* target;
+    if (c->tag->floating == false
+        && (target = find_frame_with_client(c->tag->frame, c))
+        && target->content.clients.layout == LAYOUT_MAX
+        && frame_focused_client(target) != c) {
+        // don't allow focus_follows_mouse if another window would be
+        // hidden during that focus change (which only occurs in max layout)
+        return;
+    }
+    focus_client(c, false, true);
 }
 
 void expose(XEvent* event) {
@@ -904,6 +1042,7 @@ void mappingnotify(XEvent* event) {
         XMappingEvent *ev = &event->xmapping;
         XRefreshKeyboardMapping(ev);
         if(ev->request == MappingKeyboard) {
+            update_keysym_trie();
             regrab_keys();
             //TODO: mouse_regrab_all();
         }
@@ -935,7 +1074,7 @@ void maprequest(XEvent* event) {
     if (is_herbstluft_window(g_display, mapreq->window)) {
         // just map the window if it wants that
         XWindowAttributes wa;
-        if (!XGetWindowAttributes(g_display, mapreq->window, &wa)) {
+        if (!X11_ROUND_TRIP(XGetWindowAttributes(g_display, mapreq->window, &wa))) {
             return;
         }
         XMapWindow(g_display, mapreq->window);
@@ -955,21 +1094,35 @@ void propertynotify(XEvent* event) {
     // printf("name is: PropertyNotify\n");
     XPropertyEvent *ev = &event->xproperty;
     HSClient* client;
-    if (ev->state == PropertyNewValue) {
-        if (is_ipc_connectable(event->xproperty.window)) {
-            ipc_handle_connection(event->xproperty.window);
-        } else if((client = get_client_from_window(ev->window))) {
-            if (ev->atom == XA_WM_HINTS) {
+    if (ev->state != PropertyNewValue) {
+        return;
+    }
+    if ((client = get_client_from_window(ev->window))) {
+        // the ICCCM atoms are predefined, all others are looked up once
+        switch (ev->atom) {
+            case XA_WM_HINTS:
                 client_update_wm_hints(client);
-            } else if (ev->atom == XA_WM_NORMAL_HINTS) {
+                break;
+            case XA_WM_NORMAL_HINTS: {
                 updatesizehints(client);
                 HSMonitor* m = find_monitor_with_tag(client->tag);
                 if (m) monitor_apply_layout(m);
-            } else if (ev->atom == XA_WM_NAME ||
-                       ev->atom == g_netatom[NetWmName]) {
-                client_update_title(client);
+                break;
             }
+            case XA_WM_NAME:
+                client_title_changed(client);
+                break;
+            default:
+                if (ewmh_atom_index(ev->atom) == NetWmName) {
+                    client_title_changed(client);
+                }
+                break;
         }
+    } else if (ev->atom == ATOM(HERBST_IPC_ARGS_ATOM)
+               && is_ipc_connectable(ev->window)) {
+        // only the args property starts a command, so other property
+        // changes do not need to query the window class
+        ipc_handle_connection(ev->window);
     }
 }
 
@@ -985,6 +1138,7 @@ void unmapnotify(XEvent* event) {
 /* ---- */
 
 int main(int argc, char* argv[]) {
+    gint64 startup_begin = get_monotonic_usec();
     init_handler_table();
 
     parse_arguments(argc, argv);
@@ -1019,6 +1173,8 @@ int main(int argc, char* argv[]) {
     ewmh_update_all();
     execute_autostart_file();
     clientlist_end_startup();
+    HSDebug("startup took %.1f ms\n",
+            (get_monotonic_usec() - startup_begin) / 1000.0);
 
     // main loop
     XEvent event;
@@ -1028,18 +1184,40 @@ int main(int argc, char* argv[]) {
     while (!g_aboutToQuit) {
         FD_ZERO(&in_fds);
         FD_SET(x11_fd, &in_fds);
-        // wait for an event or a signal
-        select(x11_fd + 1, &in_fds, 0, 0, NULL);
+        // wait for an event, a signal or the next deferred action
+        gint64 timeout = clientlist_title_timeout();
+        gint64 mouse_timeout = mouse_focus_timeout();
+        if (mouse_timeout >= 0 && (timeout < 0 || mouse_timeout < timeout)) {
+            timeout = mouse_timeout;
+        }
+        struct timeval tv;
+        tv.tv_sec = timeout / 1000000;
+        tv.tv_usec = timeout % 1000000;
+        select(x11_fd + 1, &in_fds, 0, 0, (timeout >= 0) ? &tv : NULL);
         if (g_aboutToQuit) {
             break;
         }
-        while (XPending(g_display)) {
-            XNextEvent(g_display, &event);
-            void (*handler) (XEvent*) = g_default_handler[event.type];
-            if (handler != NULL) {
-                handler(&event);
+        do {
+            while (XPending(g_display)) {
+                XNextEvent(g_display, &event);
+                HSStatsMeasure measure;
+                stats_event_begin(&measure);
+                void (*handler) (XEvent*) = NULL;
+                if (event.type < LASTEvent) {
+                    handler = g_default_handler[event.type];
+                }
+                if (handler != NULL) {
+                    handler(&event);
+                } else {
+                    monitors_handle_randr_event(&event);
+                }
+                stats_event_end(&measure, &event);
             }
-        }
+            // the title and screen changes of this batch of events
+            clientlist_flush_titles();
+            monitors_flush_detection();
+            mouse_focus_flush();
+        } while (XPending(g_display));
     }
 
     // destroy all subsystems
@@ -11,10 +11,14 @@
 #ifdef XINERAMA
 #include <X11/extensions/Xinerama.h>
 #endif /* XINERAMA */
+#ifdef XRANDR
+#include <X11/extensions/Xrandr.h>
+#endif /* XRANDR */
 
 #include "globals.h"
 #include "ipc-protocol.h"
 #include "utils.h"
+#include "x11-utils.h"
 #include "mouse.h"
 #include "hook.h"
 #include "layout.h"
@@ -25,6 +29,9 @@
 #include "stack.h"
 #include "clientlist.h"
 #include "desktopwindow.h"
+#include "trie.h"
+#include "state.h"
+#include "stats.h"
 
 // module internals:
 static int g_cur_monitor;
@@ -36,6 +43,10 @@ static HSStack* g_monitor_stack;
 static GArray*     g_monitors; // Array of HSMonitor*
 static HSObject*   g_monitor_object;
 static HSObject*   g_monitor_by_name_object;
+static HSTrie*     g_monitor_names; // monitor name -> HSMonitor*
+static int         g_randr_event_base = -1; // -1 if RandR is not available
+static int         g_randr_minor_version;
+static bool        g_detection_pending = false;
 
 typedef struct RectList {
     Rectangle rect;
@@ -46,12 +57,12 @@ static RectList* reclist_insert_disjoint(RectList* head, RectList* mt);
 static RectList* disjoin_rects(Rectangle* buf, size_t count);
 
 void monitor_init() {
-    g_monitors_locked = &(settings_find("monitors_locked")->value.i);
+    g_monitors_locked = &(settings_by_id(SETTING_MONITORS_LOCKED)->value.i);
     g_cur_monitor = 0;
     g_monitors = g_array_new(false, false, sizeof(HSMonitor*));
-    g_swap_monitors_to_get_tag = &(settings_find("swap_monitors_to_get_tag")->value.i);
-    g_smart_frame_surroundings = &(settings_find("smart_frame_surroundings")->value.i);
-    g_mouse_recenter_gap       = &(settings_find("mouse_recenter_gap")->value.i);
+    g_swap_monitors_to_get_tag = &(settings_by_id(SETTING_SWAP_MONITORS_TO_GET_TAG)->value.i);
+    g_smart_frame_surroundings = &(settings_by_id(SETTING_SMART_FRAME_SURROUNDINGS)->value.i);
+    g_mouse_recenter_gap       = &(settings_by_id(SETTING_MOUSE_RECENTER_GAP)->value.i);
     g_monitor_stack = stack_create();
     g_monitor_object = hsobject_create_and_link(hsobject_root(), "monitors");
     HSAttribute attributes[] = {
@@ -60,6 +71,20 @@ void monitor_init() {
     };
     hsobject_set_attributes(g_monitor_object, attributes);
     g_monitor_by_name_object = hsobject_create_and_link(g_monitor_object, "by-name");
+    g_monitor_names = trie_create();
+#ifdef XRANDR
+    // RandR 1.2 is needed for the outputs and their change events
+    int error_base, major;
+    if (XRRQueryExtension(g_display, &g_randr_event_base, &error_base)
+        && X11_ROUND_TRIP(XRRQueryVersion(g_display, &major,
+                                          &g_randr_minor_version))
+        && (major > 1 || g_randr_minor_version >= 2)) {
+        XRRSelectInput(g_display, g_root, RRScreenChangeNotifyMask
+                       | RRCrtcChangeNotifyMask | RROutputChangeNotifyMask);
+    } else {
+        g_randr_event_base = -1;
+    }
+#endif /* XRANDR */
 }
 
 void monitor_destroy() {
@@ -72,27 +97,44 @@ void monitor_destroy() {
             g_string_free(m->name, true);
         }
         g_string_free(m->display_name, true);
+        g_string_free(m->output, true);
         g_free(m);
     }
     hsobject_unlink_and_destroy(g_monitor_object, g_monitor_by_name_object);
     hsobject_unlink_and_destroy(hsobject_root(), g_monitor_object);
+    trie_destroy(g_monitor_names);
     stack_destroy(g_monitor_stack);
     g_array_free(g_monitors, true);
 }
 
+Rectangle monitor_padded_rect(HSMonitor* monitor) {
+    Rectangle rect = monitor->rect;
+    rect.x += monitor->pad_left;
+    rect.width -= (monitor->pad_left + monitor->pad_right);
+    rect.y += monitor->pad_up;
+    rect.height -= (monitor->pad_up + monitor->pad_down);
+    return rect;
+}
+
+Rectangle monitor_container_rect(HSMonitor* monitor) {
+    // fullscreen clients cover the pads of the monitor
+    if (!stack_is_layer_empty(monitor->tag->stack, LAYER_FULLSCREEN)) {
+        return monitor->rect;
+    }
+    return monitor_padded_rect(monitor);
+}
+
 void monitor_apply_layout(HSMonitor* monitor) {
     if (monitor) {
+        state_monitor_changed(monitor);
+        state_tag_changed(monitor->tag);
         if (*g_monitors_locked) {
             monitor->dirty = true;
             return;
         }
         monitor->dirty = false;
-        Rectangle rect = monitor->rect;
-        // apply pad
-        rect.x += monitor->pad_left;
-        rect.width -= (monitor->pad_left + monitor->pad_right);
-        rect.y += monitor->pad_up;
-        rect.height -= (monitor->pad_up + monitor->pad_down);
+        Rectangle rect = monitor_padded_rect(monitor);
+        tag_container_set_rect(monitor->tag, monitor_container_rect(monitor));
         if (!*g_smart_frame_surroundings || monitor->tag->frame->type == TYPE_FRAMES ) {
             // apply frame gap
             rect.x += *g_frame_gap;
@@ -269,6 +311,20 @@ static int rectlist_length(RectList* head) {
     return rectlist_length_acc(head, 0);
 }
 
+// returns whether any two of the rectangles overlap
+static bool rects_overlap(Rectangle* buf, size_t count) {
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++) {
+            Rectangle a = buf[i], b = buf[j];
+            if (a.x < b.x + b.width && b.x < a.x + a.width
+                && a.y < b.y + b.height && b.y < a.y + a.height) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 static RectList* disjoin_rects(Rectangle* buf, size_t count) {
     RectList* cur;
     struct RectList* rects = NULL;
@@ -329,46 +385,132 @@ int set_monitor_rects(Rectangle* templates, size_t count) {
     }
     HSTag* tag = NULL;
     int i;
+    int status = 0;
+    monitors_lock();
     for (i = 0; i < MIN(count, g_monitors->len); i++) {
         HSMonitor* m = monitor_with_index(i);
-        m->rect = templates[i];
+        // the monitors are identified by their index only
+        g_string_truncate(m->output, 0);
+        if (!rectangle_equals(m->rect, templates[i])) {
+            m->rect = templates[i];
+            monitor_apply_layout(m);
+        }
     }
     // add additional monitors
     for (; i < count; i++) {
         tag = find_unused_tag();
         if (!tag) {
-            return HERBST_TAG_IN_USE;
+            status = HERBST_TAG_IN_USE;
+            break;
         }
-        add_monitor(templates[i], tag, NULL);
+        HSMonitor* m = add_monitor(templates[i], tag, NULL);
         frame_show_recursive(tag->frame);
+        monitor_apply_layout(m);
     }
     // remove monitors if there are too much
-    while (i < g_monitors->len) {
+    while (status == 0 && i < g_monitors->len) {
         remove_monitor(i);
     }
+    monitors_unlock();
     monitor_update_focus_objects();
-    all_monitors_apply_layout();
-    return 0;
+    return status;
 }
 
-int find_monitor_index_by_name(char* name) {
-    int i;
-    for (i = 0; i < g_monitors->len; i++) {
-        HSMonitor* mon = monitor_with_index(i);
-        if (mon != NULL && mon->name != NULL && !strcmp(mon->name->str, name)) {
-            return i;
+/* sets the monitors to the detected ones. Existing monitors keep their
+ * identity (and so their tag) if their output is still there, and only the
+ * monitors whose rectangle changed are laid out again.
+ */
+static int set_monitor_outputs(Rectangle* rects, char** names, size_t count) {
+    if (count < 1) {
+        return HERBST_INVALID_ARGUMENT;
+    }
+    size_t old_count = g_monitors->len;
+    // the detected monitor assigned to each existing monitor, or -1
+    int* assigned = g_new(int, old_count);
+    bool* used = g_new0(bool, count);
+    // first by output name, ...
+    for (int i = 0; i < old_count; i++) {
+        HSMonitor* m = monitor_with_index(i);
+        assigned[i] = -1;
+        for (int j = 0; m->output->len > 0 && j < count; j++) {
+            if (!used[j] && !strcmp(m->output->str, names[j])) {
+                assigned[i] = j;
+                used[j] = true;
+                break;
+            }
         }
     }
-    return -1;
+    // ... then by geometry, e.g. for monitors from before the first
+    // detection ...
+    for (int i = 0; i < old_count; i++) {
+        for (int j = 0; assigned[i] < 0 && j < count; j++) {
+            if (!used[j] && rectangle_equals(monitor_with_index(i)->rect, rects[j])) {
+                assigned[i] = j;
+                used[j] = true;
+            }
+        }
+    }
+    // ... and the remaining monitors are reused in their order
+    for (int i = 0; i < old_count; i++) {
+        for (int j = 0; assigned[i] < 0 && j < count; j++) {
+            if (!used[j]) {
+                assigned[i] = j;
+                used[j] = true;
+            }
+        }
+    }
+    int status = 0;
+    monitors_lock();
+    for (int i = 0; i < old_count; i++) {
+        if (assigned[i] < 0) {
+            continue;
+        }
+        HSMonitor* m = monitor_with_index(i);
+        g_string_assign(m->output, names[assigned[i]]);
+        if (!rectangle_equals(m->rect, rects[assigned[i]])) {
+            m->rect = rects[assigned[i]];
+            monitor_apply_layout(m);
+        }
+    }
+    for (int j = 0; j < count; j++) {
+        if (used[j]) {
+            continue;
+        }
+        HSTag* tag = find_unused_tag();
+        if (!tag) {
+            status = HERBST_TAG_IN_USE;
+            break;
+        }
+        HSMonitor* m = add_monitor(rects[j], tag, NULL);
+        g_string_assign(m->output, names[j]);
+        frame_show_recursive(tag->frame);
+        monitor_apply_layout(m);
+    }
+    // remove the monitors whose output is gone, from the last one such that
+    // the indices stay valid
+    for (int i = old_count; i --> 0;) {
+        if (assigned[i] < 0) {
+            remove_monitor(i);
+        }
+    }
+    monitors_unlock();
+    monitor_update_focus_objects();
+    g_free(assigned);
+    g_free(used);
+    return status;
+}
+
+int find_monitor_index_by_name(char* name) {
+    HSMonitor* mon = find_monitor_by_name(name);
+    return mon ? monitor_index_of(mon) : -1;
 }
 
 HSMonitor* find_monitor_by_name(char* name) {
-    int i = find_monitor_index_by_name(name);
-    if (i == -1) {
-        return NULL;
-    } else {
-        return monitor_with_index(i);
-    }
+    return (HSMonitor*)trie_lookup(g_monitor_names, name);
+}
+
+HSTrie* monitor_name_trie() {
+    return g_monitor_names;
 }
 
 int string_to_monitor_index(char* string) {
@@ -449,6 +591,8 @@ static void monitor_link_id_object(HSMonitor* m) {
     g_string_printf(index_str, "%d", index);
     hsobject_link(g_monitor_object, &m->object, index_str->str);
     g_string_free(index_str, true);
+    // the index is part of the monitor state
+    state_monitor_changed(m);
 }
 
 HSMonitor* add_monitor(Rectangle rect, HSTag* tag, char* name) {
@@ -457,15 +601,18 @@ HSMonitor* add_monitor(Rectangle rect, HSTag* tag, char* name) {
     hsobject_init(&m->object);
     if (name) {
         hsobject_link(g_monitor_by_name_object, &m->object, name);
+        trie_insert(g_monitor_names, name, m);
     }
     m->rect = rect;
     m->tag = tag;
     m->tag_previous = tag;
     m->name = (name ? g_string_new(name) : NULL);
     m->display_name = g_string_new(name ? name : "");
+    m->output = g_string_new("");
     m->mouse.x = 0;
     m->mouse.y = 0;
     m->dirty = true;
+    m->restack_dirty = false;
     m->slice = slice_create_monitor(m);
     m->stacking_window = XCreateSimpleWindow(g_display, g_root,
                                              42, 42, 42, 42, 1, 0, 0);
@@ -476,6 +623,8 @@ HSMonitor* add_monitor(Rectangle rect, HSTag* tag, char* name) {
         ATTRIBUTE("index",    monitor_attr_index,ATTR_READ_ONLY  ),
         ATTRIBUTE("tag",      monitor_attr_tag,ATTR_READ_ONLY  ),
         ATTRIBUTE("lock_tag", m->lock_tag,    ATTR_READ_ONLY  ),
+        ATTRIBUTE("output",   m->output,      ATTR_READ_ONLY  ),
+        ATTRIBUTE_UINT("generation", m->generation, ATTR_READ_ONLY),
         ATTRIBUTE_LAST,
     };
     hsobject_set_attributes(&m->object, attributes);
@@ -590,9 +739,11 @@ int remove_monitor(int index) {
     hsobject_free(&monitor->object);
     // and remove monitor completely
     if (monitor->name) {
+        trie_remove(g_monitor_names, monitor->name->str);
         g_string_free(monitor->name, true);
     }
     g_string_free(monitor->display_name, true);
+    g_string_free(monitor->output, true);
     monitor_foreach(monitor_unlink_id_object);
     g_array_remove_index(g_monitors, index);
     g_free(monitor);
@@ -655,8 +806,10 @@ int rename_monitor_command(int argc, char** argv, GString* output) {
         // empty name -> clear name
         if (mon->name != NULL) {
             hsobject_unlink_by_name(g_monitor_by_name_object, mon->name->str);
+            trie_remove(g_monitor_names, mon->name->str);
             g_string_free(mon->name, true);
             mon->name = NULL;
+            state_monitor_changed(mon);
         }
         return 0;
     }
@@ -672,10 +825,13 @@ int rename_monitor_command(int argc, char** argv, GString* output) {
         mon->name = name;
     } else {
         hsobject_unlink_by_name(g_monitor_by_name_object, mon->name->str);
+        trie_remove(g_monitor_names, mon->name->str);
         // already named
         g_string_assign(mon->name, argv[2]);
     }
     hsobject_link(g_monitor_by_name_object, &mon->object, mon->name->str);
+    trie_insert(g_monitor_names, mon->name->str, mon);
+    state_monitor_changed(mon);
     return 0;
 }
 
@@ -815,6 +971,8 @@ int monitor_set_tag(HSMonitor* monitor, HSTag* tag) {
                 monitor_focus_by_index(monitor_index_of(other));
                 return 0;
             }
+            HSStatsMeasure measure;
+            stats_tag_switch_begin(&measure);
             // save old tag
             monitor->tag_previous = monitor->tag;
             // swap tags
@@ -831,6 +989,7 @@ int monitor_set_tag(HSMonitor* monitor, HSTag* tag) {
             drop_enternotify_events();
             monitor_update_focus_objects();
             ewmh_update_current_desktop();
+            stats_tag_switch_end(&measure);
             emit_tag_changed(other->tag, monitor_index_of(other));
             emit_tag_changed(tag, g_cur_monitor);
         } else {
@@ -840,6 +999,8 @@ int monitor_set_tag(HSMonitor* monitor, HSTag* tag) {
         }
         return 0;
     }
+    HSStatsMeasure measure;
+    stats_tag_switch_begin(&measure);
     HSTag* old_tag = monitor->tag;
     // save old tag
     monitor->tag_previous = old_tag;
@@ -851,13 +1012,16 @@ int monitor_set_tag(HSMonitor* monitor, HSTag* tag) {
     monitor->lock_frames = true;
     monitor_apply_layout(monitor);
     monitor->lock_frames = false;
-    // then show them (should reduce flicker)
+    // then show them (should reduce flicker). All windows are mapped and
+    // unmapped at once within a single server grab
+    client_visibility_begin();
     frame_show_recursive(tag->frame);
     if (!monitor->tag->floating) {
         frame_update_frame_window_visibility(monitor->tag->frame);
     }
     // 2. hide old tag
     frame_hide_recursive(old_tag->frame);
+    client_visibility_end();
     // focus window just has been shown
     // focus again to give input focus
     frame_focus_recursive(tag->frame);
@@ -865,6 +1029,7 @@ int monitor_set_tag(HSMonitor* monitor, HSTag* tag) {
     drop_enternotify_events();
     monitor_update_focus_objects();
     ewmh_update_current_desktop();
+    stats_tag_switch_end(&measure);
     emit_tag_changed(tag, g_cur_monitor);
     return 0;
 }
@@ -998,8 +1163,8 @@ void monitor_focus_by_index(int new_selection) {
         Window win, child;
         int wx, wy;
         unsigned int mask;
-        if (True == XQueryPointer(g_display, g_root, &win, &child,
-            &rx, &ry, &wx, &wy, &mask)) {
+        if (True == X11_ROUND_TRIP(XQueryPointer(g_display, g_root, &win, &child,
+            &rx, &ry, &wx, &wy, &mask))) {
             old->mouse.x = rx - old->rect.x;
             old->mouse.y = ry - old->rect.y;
             old->mouse.x = CLAMP(old->mouse.x, 0, old->rect.width-1);
@@ -1086,6 +1251,10 @@ void monitors_lock() {
     monitors_lock_changed();
 }
 
+bool monitors_are_locked() {
+    return *g_monitors_locked > 0;
+}
+
 int monitors_unlock_command(int argc, const char** argv) {
     monitors_unlock();
     return 0;
@@ -1113,6 +1282,8 @@ void monitors_lock_changed() {
             HSMonitor* m = monitor_with_index(i);
             if (m->dirty) {
                 monitor_apply_layout(m);
+            } else if (m->restack_dirty) {
+                monitor_restack(m);
             }
         }
     }
@@ -1133,6 +1304,7 @@ int monitor_lock_tag_command(int argc, char** argv, GString* output) {
         monitor = get_current_monitor();
     }
     monitor->lock_tag = true;
+    state_monitor_changed(monitor);
     return 0;
 }
 
@@ -1151,6 +1323,7 @@ int monitor_unlock_tag_command(int argc, char** argv, GString* output) {
         monitor = get_current_monitor();
     }
     monitor->lock_tag = false;
+    state_monitor_changed(monitor);
     return 0;
 }
 
@@ -1174,7 +1347,7 @@ bool detect_monitors_xinerama(Rectangle** ret_rects, size_t* ret_count) {
     if (!XineramaIsActive(g_display)) {
         return false;
     }
-    info = XineramaQueryScreens(g_display, &n);
+    info = X11_ROUND_TRIP(XineramaQueryScreens(g_display, &n));
     unique = g_new(XineramaScreenInfo, n);
     /* only consider unique geometries as separate screens */
     for (i = 0, j = 0; i < n; i++) {
@@ -1206,10 +1379,165 @@ bool detect_monitors_xinerama(Rectangle** ret_rects, size_t* ret_count) {
 
 #endif /* XINERAMA */
 
+// monitor detection using RandR (if available), which also knows the names
+// of the outputs
+#ifdef XRANDR
+#if RANDR_MAJOR > 1 || RANDR_MINOR >= 5
+// RandR 1.5 lists the monitors with a single request
+static bool detect_monitors_xrandr_15(GArray* rects, GArray* names) {
+    int n;
+    XRRMonitorInfo* info =
+        X11_ROUND_TRIP(XRRGetMonitors(g_display, g_root, True, &n));
+    if (!info) {
+        return false;
+    }
+    Atom* atoms = g_new(Atom, n);
+    char** atom_names = g_new0(char*, n);
+    for (int i = 0; i < n; i++) {
+        atoms[i] = info[i].name;
+    }
+    X11_ROUND_TRIP(XGetAtomNames(g_display, atoms, n, atom_names));
+    for (int i = 0; i < n; i++) {
+        Rectangle rect(info[i].x, info[i].y, info[i].width, info[i].height);
+        char* name = g_strdup(atom_names[i] ? atom_names[i] : "");
+        g_array_append_val(rects, rect);
+        g_array_append_val(names, name);
+        if (atom_names[i]) {
+            XFree(atom_names[i]);
+        }
+    }
+    g_free(atoms);
+    g_free(atom_names);
+    XRRFreeMonitors(info);
+    return true;
+}
+#endif
+
+// RandR 1.2 needs a request for each output and each crtc
+static bool detect_monitors_xrandr_12(GArray* rects, GArray* names) {
+    XRRScreenResources* res = (g_randr_minor_version >= 3)
+        ? X11_ROUND_TRIP(XRRGetScreenResourcesCurrent(g_display, g_root))
+        : X11_ROUND_TRIP(XRRGetScreenResources(g_display, g_root));
+    if (!res) {
+        return false;
+    }
+    for (int i = 0; i < res->noutput; i++) {
+        XRROutputInfo* output =
+            X11_ROUND_TRIP(XRRGetOutputInfo(g_display, res, res->outputs[i]));
+        if (!output) {
+            continue;
+        }
+        if (output->connection == RR_Connected && output->crtc) {
+            XRRCrtcInfo* crtc =
+                X11_ROUND_TRIP(XRRGetCrtcInfo(g_display, res, output->crtc));
+            if (crtc && crtc->width > 0 && crtc->height > 0) {
+                Rectangle rect(crtc->x, crtc->y, crtc->width, crtc->height);
+                char* name = g_strndup(output->name, output->nameLen);
+                g_array_append_val(rects, rect);
+                g_array_append_val(names, name);
+            }
+            if (crtc) {
+                XRRFreeCrtcInfo(crtc);
+            }
+        }
+        XRRFreeOutputInfo(output);
+    }
+    XRRFreeScreenResources(res);
+    return true;
+}
+
+bool detect_monitors_xrandr(Rectangle** ret_rects, char*** ret_names,
+                            size_t* ret_count) {
+    if (g_randr_event_base < 0) {
+        return false;
+    }
+    GArray* rects = g_array_new(false, false, sizeof(Rectangle));
+    GArray* names = g_array_new(true, false, sizeof(char*));
+    bool success = false;
+#if RANDR_MAJOR > 1 || RANDR_MINOR >= 5
+    if (g_randr_minor_version >= 5) {
+        success = detect_monitors_xrandr_15(rects, names);
+    }
+#endif
+    if (!success) {
+        success = detect_monitors_xrandr_12(rects, names);
+    }
+    // cloned outputs show the same content, so they are one monitor
+    for (int i = rects->len; i --> 0;) {
+        for (int j = 0; j < i; j++) {
+            if (rectangle_equals(g_array_index(rects, Rectangle, i),
+                                 g_array_index(rects, Rectangle, j))) {
+                g_free(g_array_index(names, char*, i));
+                g_array_remove_index(rects, i);
+                g_array_remove_index(names, i);
+                break;
+            }
+        }
+    }
+    if (!success || rects->len == 0) {
+        g_array_free(rects, true);
+        g_strfreev((char**)g_array_free(names, false));
+        return false;
+    }
+    *ret_count = rects->len;
+    *ret_rects = (Rectangle*)g_array_free(rects, false);
+    *ret_names = (char**)g_array_free(names, false);
+    return true;
+}
+#else  /* XRANDR */
+
+bool detect_monitors_xrandr(Rectangle** ret_rects, char*** ret_names,
+                            size_t* ret_count) {
+    return false;
+}
+
+#endif /* XRANDR */
+
+bool monitors_randr_active() {
+    return g_randr_event_base >= 0;
+}
+
+bool monitors_handle_randr_event(XEvent* event) {
+#ifdef XRANDR
+    if (g_randr_event_base < 0) {
+        return false;
+    }
+    int type = event->type - g_randr_event_base;
+    if (type != RRScreenChangeNotify && type != RRNotify) {
+        return false;
+    }
+    if (type == RRScreenChangeNotify) {
+        XRRUpdateConfiguration(event);
+        g_screen_width = DisplayWidth(g_display, g_screen);
+        g_screen_height = DisplayHeight(g_display, g_screen);
+        tag_containers_update_size();
+    }
+    monitors_detect_later();
+    return true;
+#else  /* XRANDR */
+    return false;
+#endif /* XRANDR */
+}
+
+void monitors_detect_later() {
+    if (settings_by_id(SETTING_AUTO_DETECT_MONITORS)->value.i) {
+        g_detection_pending = true;
+    }
+}
+
+void monitors_flush_detection() {
+    if (!g_detection_pending) {
+        return;
+    }
+    g_detection_pending = false;
+    const char* args[] = { "detect_monitors" };
+    detect_monitors_command(LENGTH(args), args, NULL);
+}
+
 // monitor detection that always works: one monitor across the entire screen
 bool detect_monitors_simple(Rectangle** ret_rects, size_t* ret_count) {
     XWindowAttributes attributes;
-    XGetWindowAttributes(g_display, g_root, &attributes);
+    X11_ROUND_TRIP(XGetWindowAttributes(g_display, g_root, &attributes));
 
     *ret_count = 1;
     *ret_rects = g_new0(Rectangle, 1);
@@ -1242,12 +1570,15 @@ int detect_monitors_command(int argc, const char **argv, GString* output) {
         detect_monitors_debug_example, // move up for debugging
     };
     Rectangle* monitors = NULL;
+    char** names = NULL; // only known with RandR
     size_t count = 0;
     // search for a working monitor detection
     // at least the simple detection must work
-    for (int i = 0; i < LENGTH(detect); i++) {
-        if (detect[i](&monitors, &count)) {
-            break;
+    if (!detect_monitors_xrandr(&monitors, &names, &count)) {
+        for (int i = 0; i < LENGTH(detect); i++) {
+            if (detect[i](&monitors, &count)) {
+                break;
+            }
         }
     }
     assert(count && monitors);
@@ -1263,6 +1594,8 @@ int detect_monitors_command(int argc, const char **argv, GString* output) {
         else {
             g_string_append_printf(output,
                 "detect_monitors: unknown flag \"%s\"\n", argv[i]);
+            g_free(monitors);
+            g_strfreev(names);
             return HERBST_INVALID_ARGUMENT;
         }
     }
@@ -1274,6 +1607,13 @@ int detect_monitors_command(int argc, const char **argv, GString* output) {
                 monitors[i].width, monitors[i].height,
                 monitors[i].x, monitors[i].y);
         }
+    } else if (names && !(disjoin && rects_overlap(monitors, count))) {
+        // the outputs are known, so only apply what changed
+        ret = set_monitor_outputs(monitors, names, count);
+        if (ret == HERBST_TAG_IN_USE && output != NULL) {
+            g_string_append_printf(output,
+                "%s: There are not enough free tags\n", argv[0]);
+        }
     } else {
         // possibly disjoin them
         if (disjoin) {
@@ -1296,6 +1636,7 @@ int detect_monitors_command(int argc, const char **argv, GString* output) {
         }
     }
     g_free(monitors);
+    g_strfreev(names);
     return ret;
 }
 
@@ -1331,13 +1672,33 @@ int monitor_raise_command(int argc, char** argv, GString* output) {
 }
 
 void monitor_restack(HSMonitor* monitor) {
-    int count = 1 + stack_window_count(monitor->tag->stack, false);
-    Window* buf = g_new(Window, count);
+    if (*g_monitors_locked) {
+        monitor->restack_dirty = true;
+        return;
+    }
+    monitor->restack_dirty = false;
+    HSClient* client = frame_focused_client(monitor->tag->frame);
+    bool fullscreen = client && client->fullscreen;
+    int offset = 1;
+    if (monitor->tag->container) {
+        // the windows in the container are no siblings of the stacking
+        // window, so only the container is put below the stacking window.
+        // For a focused fullscreen client, it is raised above the panels.
+        if (fullscreen) {
+            XRaiseWindow(g_display, monitor->tag->container);
+        } else {
+            Window pair[] = { monitor->stacking_window, monitor->tag->container };
+            XRestackWindows(g_display, pair, LENGTH(pair));
+        }
+        offset = 0;
+    }
+    int count = offset + stack_window_count(monitor->tag->stack, false);
+    Window* buf = g_new(Window, count + 1);
     buf[0] = monitor->stacking_window;
-    stack_to_window_buf(monitor->tag->stack, buf + 1, count - 1, false, NULL);
+    stack_to_window_buf(monitor->tag->stack, buf + offset, count - offset,
+                        false, NULL);
     /* remove a focused fullscreen client */
-    HSClient* client = frame_focused_client(monitor->tag->frame);
-    if (client && client->fullscreen) {
+    if (fullscreen) {
         XRaiseWindow(g_display, client->dec.decwin);
         int idx = array_find(buf, count, sizeof(*buf), &client->dec.decwin);
         assert(idx >= 0);
@@ -1346,6 +1707,7 @@ void monitor_restack(HSMonitor* monitor) {
     }
     DesktopWindow::lowerDesktopWindows();
     XRestackWindows(g_display, buf, count);
+    stack_clean(monitor->tag->stack);
     g_free(buf);
 }
 
@@ -1375,8 +1737,10 @@ void all_monitors_replace_previous_tag(HSTag *old, HSTag *newmon) {
 }
 
 void drop_enternotify_events() {
+    // a window entered before is not focused after the changes by us either
+    mouse_focus_cancel();
     XEvent ev;
-    XSync(g_display, False);
+    X11_ROUND_TRIP(XSync(g_display, False));
     while(XCheckMaskEvent(g_display, EnterWindowMask, &ev));
 }
 
@@ -21,6 +21,7 @@ struct HSTag;
 struct HSFrame;
 struct HSSlice;
 struct HSStack;
+struct HSTrie;
 
 typedef struct HSMonitor {
     struct HSTag*      tag;    // currently viewed tag
@@ -29,13 +30,16 @@ typedef struct HSMonitor {
     HSObject    object;
     GString*    name;
     GString*    display_name;   // name used for object IO
+    GString*    output; // name of the RandR output, empty if unknown
     int         pad_up;
     int         pad_right;
     int         pad_down;
     int         pad_left;
     bool        dirty;
+    bool        restack_dirty; // restack while monitors were locked
     bool        lock_frames;
     bool        lock_tag;
+    unsigned int generation; // global generation of the last change
     struct {
         // last saved mouse position
         int x;
@@ -63,6 +67,7 @@ int monitor_cycle_command(int argc, char** argv);
 int monitor_focus_command(int argc, char** argv, GString* output);
 int find_monitor_index_by_name(char* name);
 HSMonitor* find_monitor_by_name(char* name);
+struct HSTrie* monitor_name_trie(); // for completion
 HSMonitor* string_to_monitor(char* string);
 int string_to_monitor_index(char* string);
 int monitor_index_in_direction(HSMonitor* m, enum HSDirection dir);
@@ -86,6 +91,8 @@ int monitor_set_tag_command(int argc, char** argv, GString* output);
 int monitor_set_tag_by_index_command(int argc, char** argv, GString* output);
 int monitor_set_previous_tag_command(int argc, char** argv, GString* output);
 void monitors_lock();
+// returns whether monitor_apply_layout() is deferred
+bool monitors_are_locked();
 void monitors_unlock();
 int monitors_lock_command(int argc, const char** argv);
 int monitors_unlock_command(int argc, const char** argv);
@@ -93,6 +100,11 @@ void monitors_lock_changed();
 int monitor_lock_tag_command(int argc, char** argv, GString* output);
 int monitor_unlock_tag_command(int argc, char** argv, GString* output);
 void monitor_apply_layout(HSMonitor* monitor);
+// the rect of the monitor without its padding
+Rectangle monitor_padded_rect(HSMonitor* monitor);
+// the rect of the tag container of the monitor, which covers the pads if the
+// tag has fullscreen clients
+Rectangle monitor_container_rect(HSMonitor* monitor);
 void all_monitors_apply_layout();
 void ensure_monitors_are_available();
 void all_monitors_replace_previous_tag(struct HSTag* old, struct HSTag* newmon);
@@ -110,8 +122,20 @@ void monitor_update_focus_objects();
 typedef bool (*MonitorDetection)(Rectangle**, size_t*);
 bool detect_monitors_xinerama(Rectangle** ret_rects, size_t* ret_count);
 bool detect_monitors_simple(Rectangle** ret_rects, size_t* ret_count);
+// also returns the output names as a NULL-terminated list
+bool detect_monitors_xrandr(Rectangle** ret_rects, char*** ret_names,
+                            size_t* ret_count);
 int detect_monitors_command(int argc, const char **argv, GString* output);
 
+// returns whether RandR change events are received
+bool monitors_randr_active();
+// handles the event if it is a RandR event and returns whether it was one
+bool monitors_handle_randr_event(XEvent* event);
+// runs detect_monitors once for all screen changes that came in since the
+// last call, if auto_detect_monitors is set
+void monitors_detect_later();
+void monitors_flush_detection();
+
 int shift_to_monitor(int argc, char** argv, GString* output);
 
 #endif
@@ -10,6 +10,7 @@
 #include "key.h"
 #include "ipc-protocol.h"
 #include "utils.h"
+#include "x11-utils.h"
 #include "settings.h"
 #include "command.h"
 
@@ -49,8 +50,8 @@ static int* g_snap_gap;
 
 void mouse_init() {
     g_numlockmask_ptr = get_numlockmask_ptr();
-    g_snap_distance = &(settings_find("snap_distance")->value.i);
-    g_snap_gap = &(settings_find("snap_gap")->value.i);
+    g_snap_distance = &(settings_by_id(SETTING_SNAP_DISTANCE)->value.i);
+    g_snap_gap = &(settings_by_id(SETTING_SNAP_GAP)->value.i);
     /* set cursor theme */
     g_cursor = XCreateFontCursor(g_display, XC_left_ptr);
     XDefineCursor(g_display, g_root, g_cursor);
@@ -115,9 +116,9 @@ void mouse_initiate_drag(HSClient* client, MouseDragFunction function) {
     g_win_drag_start = g_win_drag_client->float_size;
     g_button_drag_start = get_cursor_position();
     g_drag_init_done = false;
-    XGrabPointer(g_display, client->window, True,
+    X11_ROUND_TRIP(XGrabPointer(g_display, client->window, True,
         PointerMotionMask|ButtonReleaseMask, GrabModeAsync,
-            GrabModeAsync, None, None, CurrentTime);
+            GrabModeAsync, None, None, CurrentTime));
 }
 
 void mouse_stop_drag() {
@@ -132,7 +133,7 @@ void mouse_stop_drag() {
     // remove all enternotify-events from the event queue that were
     // generated by the XUngrabPointer
     XEvent ev;
-    XSync(g_display, False);
+    X11_ROUND_TRIP(XSync(g_display, False));
     while(XCheckMaskEvent(g_display, EnterWindowMask, &ev));
 }
 
@@ -445,8 +446,8 @@ void mouse_function_resize_floated(XMotionEvent* me) {
     int min_height = WINDOW_MIN_HEIGHT;
     HSClient* client = g_win_drag_client;
     if (client->sizehints_floating) {
-        min_width = MAX(WINDOW_MIN_WIDTH, client->minw);
-        min_height = MAX(WINDOW_MIN_HEIGHT, client->minh);
+        min_width = MAX(WINDOW_MIN_WIDTH, client->size_hints.minw);
+        min_height = MAX(WINDOW_MIN_HEIGHT, client->size_hints.minh);
     }
     if (new_width <  min_width) {
         new_width = min_width;
@@ -547,11 +548,6 @@ bool is_point_between(int point, int left, int right) {
     return (point < right && point >= left);
 }
 
-// tells if the intervals [a_left, a_right) [b_left, b_right) intersect
-bool intervals_intersect(int a_left, int a_right, int b_left, int b_right) {
-    return (b_left < a_right) && (a_left < b_right);
-}
-
 // compute vector to snap a point to an edge
 static void snap_1d(int x, int edge, int* delta) {
     // whats the vector from subject to edge?
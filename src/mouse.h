@@ -56,6 +56,9 @@ void mouse_handle_event(XEvent* ev);
 void mouse_initiate_drag(struct HSClient* client, MouseDragFunction function);
 void mouse_stop_drag();
 bool mouse_is_dragging();
+// forgets the window that focus_follows_mouse would focus next, such that an
+// explicit focus change is not undone (see enternotify() in main.cpp)
+void mouse_focus_cancel();
 void handle_motion_event(XEvent* ev);
 
 // get the vector to snap a client to it's neighbour
@@ -65,7 +68,6 @@ void client_snap_vector(struct HSClient* client, struct HSMonitor* monitor,
 
 bool is_point_between(int point, int left, int right);
 // tells if the intervals [a_left, a_right) [b_left, b_right) intersect
-bool intervals_intersect(int a_left, int a_right, int b_left, int b_right);
 
 void mouse_initiate_move(struct HSClient* client, int argc, char** argv);
 void mouse_initiate_zoom(struct HSClient* client, int argc, char** argv);
@@ -9,6 +9,7 @@
 #include "assert.h"
 #include "globals.h"
 #include "ipc-protocol.h"
+#include "trie.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -45,6 +46,7 @@ bool hsobject_init(HSObject* obj) {
     obj->attributes = NULL;
     obj->attribute_count = 0;
     obj->children = NULL;
+    obj->child_names = NULL;
     return true;
 }
 
@@ -54,6 +56,7 @@ void hsobject_free(HSObject* obj) {
     }
     g_free(obj->attributes);
     g_list_free_full(obj->children, (GDestroyNotify)hsobjectchild_destroy);
+    trie_destroy(obj->child_names);
 }
 
 static void hsattribute_free(HSAttribute* attr) {
@@ -112,20 +115,32 @@ struct HSObjectComplChild {
     GString* output;
 };
 
-static void completion_helper(HSObjectChild* child, struct HSObjectComplChild* data) {
-    g_string_assign(data->curname, child->name);
+static void completion_helper(const char* name, void* child, void* user_data) {
+    struct HSObjectComplChild* data = (struct HSObjectComplChild*) user_data;
+    g_string_assign(data->curname, name);
     g_string_append_c(data->curname, OBJECT_PATH_SEPARATOR);
     try_complete_prefix_partial(data->needle, data->curname->str, data->prefix, data->output);
 }
 
 void hsobject_complete_children(HSObject* obj, const char* needle, const char* prefix, GString* output) {
+    if (!obj->child_names) {
+        return;
+    }
     struct HSObjectComplChild data = {
         needle,
         prefix,
         g_string_new(""),
         output
     };
-    g_list_foreach(obj->children, (GFunc) completion_helper, &data);
+    // the needle may already contain a separator, e.g. "tags.by-name.",
+    // then only the part before it narrows down the child names
+    GString* lookup = g_string_new(needle);
+    const char* sep = strchr(lookup->str, OBJECT_PATH_SEPARATOR);
+    if (sep) {
+        g_string_truncate(lookup, sep - lookup->str);
+    }
+    trie_foreach_prefix(obj->child_names, lookup->str, completion_helper, &data);
+    g_string_free(lookup, true);
     g_string_free(data.curname, true);
 }
 
@@ -152,6 +167,10 @@ void hsobject_link(HSObject* parent, HSObject* child, const char* name) {
         // create a new child node
         HSObjectChild* oc = hsobjectchild_create(name, child);
         parent->children = g_list_append(parent->children, oc);
+        if (!parent->child_names) {
+            parent->child_names = trie_create();
+        }
+        trie_insert(parent->child_names, oc->name, oc);
     } else {
         // replace it
         HSObjectChild* oc = (HSObjectChild*) elem->data;
@@ -170,7 +189,9 @@ static void hsobject_unlink_helper(HSObject* parent, GCompareFunc f, const void*
         elem = g_list_find_custom(elem, data, f);
         if (elem) {
             GList* next = elem->next;
-            hsobjectchild_destroy((HSObjectChild*)elem->data);
+            HSObjectChild* oc = (HSObjectChild*)elem->data;
+            trie_remove(parent->child_names, oc->name);
+            hsobjectchild_destroy(oc);
             parent->children = g_list_delete_link(parent->children, elem);
             elem = next;
         }
@@ -199,8 +220,10 @@ void hsobject_link_rename(HSObject* parent, char* oldname, char* newname) {
                                      oldname,
                                      (GCompareFunc)child_check_name);
     HSObjectChild* child = (HSObjectChild*)elem->data;
+    trie_remove(parent->child_names, child->name);
     g_free(child->name);
     child->name = g_strdup(newname);
+    trie_insert(parent->child_names, child->name, child);
 }
 
 void hsobject_link_rename_object(HSObject* parent, HSObject* child, char* newname) {
@@ -211,13 +234,11 @@ void hsobject_link_rename_object(HSObject* parent, HSObject* child, char* newnam
 }
 
 HSObject* hsobject_find_child(HSObject* obj, const char* name) {
-    GList* elem = g_list_find_custom(obj->children, name,
-                                     (GCompareFunc)child_check_name);
-    if (elem) {
-        return ((HSObjectChild*)(elem->data))->child;
-    } else {
+    if (!obj->child_names) {
         return NULL;
     }
+    HSObjectChild* oc = (HSObjectChild*)trie_lookup(obj->child_names, name);
+    return oc ? oc->child : NULL;
 }
 
 HSAttribute* hsobject_find_attribute(HSObject* obj, const char* name) {
@@ -353,17 +374,21 @@ static size_t object_child_count(HSTree tree) {
     return g_list_length(oc->child->children);
 }
 
-static HSTreeInterface object_nth_child(HSTree tree, size_t idx) {
+static void object_foreach_child(HSTree tree, HSTreeChildAction action,
+                                 void* data) {
     HSObjectChild* oc = (HSObjectChild*) tree;
     assert(oc->child);
     HSTreeInterface intf = {
-        /* .nth_child  = */ object_nth_child,
+        /* .foreach_child  = */ object_foreach_child,
         /* .child_count    = */ object_child_count,
         /* .append_caption = */ object_append_caption,
-        /* .data       = */ (HSTree) g_list_nth_data(oc->child->children, idx),
-        /* .destructor = */ NULL,
+        /* .data           = */ NULL,
+        /* .destructor     = */ NULL,
     };
-    return intf;
+    for (GList* cur = oc->child->children; cur; cur = cur->next) {
+        intf.data = (HSTree) cur->data;
+        action(&intf, data);
+    }
 }
 
 HSObject* hsobject_by_path(char* path) {
@@ -471,7 +496,7 @@ int print_object_tree_command(int argc, char* argv[], GString* output) {
         return HERBST_INVALID_ARGUMENT;
     }
     HSTreeInterface intf = {
-        /* .nth_child  = */ object_nth_child,
+        /* .foreach_child  = */ object_foreach_child,
         /* .child_count    = */ object_child_count,
         /* .append_caption = */ object_append_caption,
         /* .data       = */ &oc,
@@ -15,11 +15,13 @@
 #define TMP_OBJECT_PATH "tmp"
 
 class HSAttribute;
+struct HSTrie;
 
 typedef struct HSObject {
     HSAttribute* attributes;
     size_t              attribute_count;
     GList*              children; // list of HSObjectChild
+    struct HSTrie*      child_names; // name -> HSObjectChild, or NULL
     void*               data;     // user data pointer
 } HSObject;
 
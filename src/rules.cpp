@@ -11,6 +11,7 @@
 #include "ipc-protocol.h"
 #include "hook.h"
 #include "command.h"
+#include "trie.h"
 
 #include "glib-backports.h"
 #include "glib-backports.h"
@@ -80,6 +81,9 @@ static HSConditionType g_condition_types[] = {
 
 static int     g_maxage_type; // index of "maxage"
 static time_t  g_current_rule_birth_time; // data from rules_apply() to condition_maxage()
+// the prefetched window properties from rules_apply(), NULL if they have to
+// be fetched by the conditions
+static const HSWindowInfo* g_current_window_info;
 static unsigned long long g_rule_label_index; // incremental index of rule label
 
 static HSConsequenceType g_consequence_types[] = {
@@ -98,17 +102,35 @@ static HSConsequenceType g_consequence_types[] = {
 };
 
 static GQueue g_rules = G_QUEUE_INIT; // a list of HSRule* elements
+static HSTrie* g_rule_labels = NULL; // label -> number of rules with it
 
 /// FUNCTIONS ///
 // RULES //
 void rules_init() {
     g_maxage_type = find_condition_type("maxage");
     g_rule_label_index = 0;
+    g_rule_labels = trie_create();
 }
 
 void rules_destroy() {
     g_queue_foreach(&g_rules, (GFunc)rule_destroy, NULL);
     g_queue_clear(&g_rules);
+    trie_destroy(g_rule_labels);
+    g_rule_labels = NULL;
+}
+
+// counts the rules per label, so labels can be completed without scanning
+// all rules
+static void rule_label_ref(const char* label) {
+    int count = GPOINTER_TO_INT(trie_lookup(g_rule_labels, label));
+    trie_insert(g_rule_labels, label, GINT_TO_POINTER(count + 1));
+}
+
+static void rule_label_unref(const char* label) {
+    int count = GPOINTER_TO_INT(trie_remove(g_rule_labels, label));
+    if (count > 1) {
+        trie_insert(g_rule_labels, label, GINT_TO_POINTER(count - 1));
+    }
 }
 
 // condition types //
@@ -329,6 +351,9 @@ static gint rule_compare_label(const HSRule* a, const HSRule* b) {
 static bool rule_find_pop(char* label) {
     GList* rule = { NULL };
     bool status = false; // Will be returned as true if any is found
+    if (!trie_remove(g_rule_labels, label)) {
+        return false;
+    }
     HSRule rule_find = { 0 };
     rule_find.label = label;
     while ((rule = g_queue_find_custom(&g_rules, &rule_find,
@@ -518,9 +543,36 @@ int rule_add_command(int argc, char** argv, GString* output) {
 
     if (prepend) g_queue_push_head(&g_rules, rule);
     else         g_queue_push_tail(&g_rules, rule);
+    rule_label_ref(rule->label);
     return 0;
 }
 
+bool rule_parse_condition(HSRule* rule, char* arg, bool* negated,
+                          GString* output) {
+    if (!strcmp(arg, "not") || !strcmp(arg, "!")) {
+        *negated = ! *negated;
+        return true;
+    }
+    char* name;
+    char* value;
+    char op;
+    int type;
+    if (!tokenize_arg(arg, &name, &op, &value)
+        || (type = find_condition_type(name)) < 0) {
+        g_string_append_printf(output,
+            "Unknown condition \"%s\"\n", arg);
+        return false;
+    }
+    HSCondition* cond = condition_create(type, op, value, output);
+    if (!cond) {
+        return false;
+    }
+    cond->negated = *negated;
+    *negated = false;
+    rule_add_condition(rule, cond);
+    return true;
+}
+
 void complete_against_rule_names(int argc, char** argv, int pos, GString* output) {
     const char* needle;
     if (pos >= argc) {
@@ -529,11 +581,7 @@ void complete_against_rule_names(int argc, char** argv, int pos, GString* output
         needle = argv[pos];
     }
     // Complete labels
-    GList* cur_rule = g_queue_peek_head_link(&g_rules);
-    while (cur_rule != NULL) {
-        try_complete(needle, ((HSRule*)cur_rule->data)->label, output);
-        cur_rule = g_list_next(cur_rule);
-    }
+    complete_against_trie(needle, g_rule_labels, output);
 }
 
 
@@ -546,6 +594,7 @@ int rule_remove_command(int argc, char** argv, GString* output) {
         // remove all rules
         g_queue_foreach(&g_rules, (GFunc)rule_destroy, NULL);
         g_queue_clear(&g_rules);
+        trie_clear(g_rule_labels);
         g_rule_label_index = 0;
         return 0;
     }
@@ -583,40 +632,53 @@ void client_changes_free_members(HSClientChanges* changes) {
 }
 
 // apply all rules to a certain client an save changes
-void rules_apply(HSClient* client, HSClientChanges* changes) {
-    GList* cur = g_rules.head;
-    while (cur) {
-        HSRule* rule = (HSRule*)cur->data;
-        bool matches = true;    // if current condition matches
-        bool rule_match = true; // if entire rule matches
-        bool rule_expired = false;
-        g_current_rule_birth_time = rule->birth_time;
+// checks all conditions of rule. expired is set if the rule will never
+// match again in the future
+static bool rule_match_conditions(HSRule* rule, HSClient* client, bool* expired) {
+    bool matches = true;    // if current condition matches
+    bool rule_match = true; // if entire rule matches
+    g_current_rule_birth_time = rule->birth_time;
 
-        // check all conditions
-        for (int i = 0; i < rule->condition_count; i++) {
-            int type = rule->conditions[i]->condition_type;
+    for (int i = 0; i < rule->condition_count; i++) {
+        int type = rule->conditions[i]->condition_type;
 
-            if (!rule_match && type != g_maxage_type) {
-                // implement lazy AND &&
-                // ... except for maxage
-                continue;
-            }
+        if (!rule_match && type != g_maxage_type) {
+            // implement lazy AND &&
+            // ... except for maxage
+            continue;
+        }
 
-            matches = g_condition_types[type].
-                matches(rule->conditions[i], client);
+        matches = g_condition_types[type].
+            matches(rule->conditions[i], client);
 
-            if (!matches && !rule->conditions[i]->negated
-                && rule->conditions[i]->condition_type == g_maxage_type) {
-                // if if not negated maxage does not match anymore
-                // then it will never match again in the future
-                rule_expired = true;
-            }
+        if (!matches && !rule->conditions[i]->negated
+            && rule->conditions[i]->condition_type == g_maxage_type) {
+            // if if not negated maxage does not match anymore
+            // then it will never match again in the future
+            *expired = true;
+        }
 
-            if (rule->conditions[i]->negated) {
-                matches = ! matches;
-            }
-            rule_match = rule_match && matches;
+        if (rule->conditions[i]->negated) {
+            matches = ! matches;
         }
+        rule_match = rule_match && matches;
+    }
+    return rule_match;
+}
+
+bool rule_matches(HSRule* rule, HSClient* client) {
+    bool expired = false;
+    return rule_match_conditions(rule, client, &expired);
+}
+
+void rules_apply(HSClient* client, HSClientChanges* changes,
+                 const HSWindowInfo* info) {
+    g_current_window_info = info;
+    GList* cur = g_rules.head;
+    while (cur) {
+        HSRule* rule = (HSRule*)cur->data;
+        bool rule_expired = false;
+        bool rule_match = rule_match_conditions(rule, client, &rule_expired);
 
         if (rule_match) {
             // apply all consequences
@@ -631,6 +693,7 @@ void rules_apply(HSClient* client, HSClientChanges* changes) {
         // remove it if not wanted or needed anymore
         if ((rule_match && rule->once) || rule_expired) {
             GList* next = cur->next;
+            rule_label_unref(((HSRule*)cur->data)->label);
             rule_destroy((HSRule*)cur->data);
             g_queue_remove_element(&g_rules, cur);
             cur = next;
@@ -640,6 +703,7 @@ void rules_apply(HSClient* client, HSClientChanges* changes) {
         // try next
         cur = cur ? cur->next : NULL;
     }
+    g_current_window_info = NULL;
 }
 
 /// CONDITIONS ///
@@ -675,6 +739,9 @@ static bool condition_string(HSCondition* rule, const char* string) {
 }
 
 static bool condition_class(HSCondition* rule, HSClient* client) {
+    if (g_current_window_info) {
+        return condition_string(rule, g_current_window_info->window_class->str);
+    }
     GString* window_class = window_class_to_g_string(g_display, client->window);
     bool match = condition_string(rule, window_class->str);
     g_string_free(window_class, true);
@@ -682,6 +749,9 @@ static bool condition_class(HSCondition* rule, HSClient* client) {
 }
 
 static bool condition_instance(HSCondition* rule, HSClient* client) {
+    if (g_current_window_info) {
+        return condition_string(rule, g_current_window_info->instance->str);
+    }
     GString* inst = window_instance_to_g_string(g_display, client->window);
     bool match = condition_string(rule, inst->str);
     g_string_free(inst, true);
@@ -711,7 +781,9 @@ static bool condition_maxage(HSCondition* rule, HSClient* client) {
 }
 
 static bool condition_windowtype(HSCondition* rule, HSClient* client) {
-    int windowtype = ewmh_get_window_type(client->window);
+    int windowtype = g_current_window_info
+        ? g_current_window_info->window_type
+        : ewmh_get_window_type(client->window);
     if (windowtype < 0) {
         return false;
     } else {
@@ -723,6 +795,10 @@ static bool condition_windowtype(HSCondition* rule, HSClient* client) {
 }
 
 static bool condition_windowrole(HSCondition* rule, HSClient* client) {
+    if (g_current_window_info) {
+        GString* role = g_current_window_info->role;
+        return role && condition_string(rule, role->str);
+    }
     GString* role = window_property_to_g_string(g_display, client->window,
         ATOM("WM_WINDOW_ROLE"));
     if (!role) return false;
@@ -69,13 +69,22 @@ typedef struct {
 
 void rules_init();
 void rules_destroy();
-void rules_apply(struct HSClient* client, HSClientChanges* changes);
+// info are the prefetched properties of the client's window, see
+// window_info_fetch()
+void rules_apply(struct HSClient* client, HSClientChanges* changes,
+                 const struct HSWindowInfo* info);
 
 void client_changes_init(HSClientChanges* changes, struct HSClient* client);
 void client_changes_free_members(HSClientChanges* changes);
 
 HSRule* rule_create();
 void rule_destroy(HSRule* rule);
+// parses arg as a condition (or a not flag) and adds it to rule. Returns
+// false and prints an error message if arg is no valid condition.
+bool rule_parse_condition(HSRule* rule, char* arg, bool* negated,
+                          GString* output);
+// returns whether client matches all conditions of rule
+bool rule_matches(HSRule* rule, struct HSClient* client);
 
 void rule_complete(int argc, char** argv, int pos, GString* output);
 
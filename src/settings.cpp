@@ -11,6 +11,7 @@
 #include "utils.h"
 #include "ewmh.h"
 #include "object.h"
+#include "trie.h"
 
 #include "glib-backports.h"
 #include <string.h>
@@ -57,72 +58,28 @@ SettingsPair SET_COMPAT(const char* name, const char* read, const char* write)
 #define FOCUS_LAYER tag_update_each_focus_layer
 #define WMNAME ewmh_update_wmname
 
-// default settings:
-SettingsPair g_settings[] = {
-    SET_INT(    "verbose",                         0,           update_verbose),
-    SET_INT(    "frame_gap",                       5,           RELAYOUT      ),
-    SET_INT(    "frame_padding",                   0,           RELAYOUT      ),
-    SET_INT(    "window_gap",                      0,           RELAYOUT      ),
-    SET_INT(    "snap_distance",                   10,          NULL          ),
-    SET_INT(    "snap_gap",                        5,           NULL          ),
-    SET_INT(    "mouse_recenter_gap",              0,           NULL          ),
-    SET_STRING( "frame_border_active_color",       "red",       FR_COLORS     ),
-    SET_STRING( "frame_border_normal_color",       "blue",      FR_COLORS     ),
-    SET_STRING( "frame_border_inner_color",        "black",     FR_COLORS     ),
-    SET_STRING( "frame_bg_normal_color",           "black",     FR_COLORS     ),
-    SET_STRING( "frame_bg_active_color",           "black",     FR_COLORS     ),
-    SET_INT(    "frame_bg_transparent",            0,           FR_COLORS     ),
-    SET_INT(    "frame_transparent_width",         0,           FR_COLORS     ),
-    SET_INT(    "frame_border_width",              2,           FR_COLORS     ),
-    SET_INT(    "frame_border_inner_width",        0,           FR_COLORS     ),
-    SET_INT(    "frame_active_opacity",            100,         FR_COLORS     ),
-    SET_INT(    "frame_normal_opacity",            100,         FR_COLORS     ),
-    SET_INT(    "focus_crosses_monitor_boundaries", 1,          NULL          ),
-    SET_INT(    "always_show_frame",               0,           RELAYOUT      ),
-    SET_INT(    "default_direction_external_only", 0,           NULL          ),
-    SET_INT(    "default_frame_layout",            0,           FR_COLORS     ),
-    SET_INT(    "focus_follows_mouse",             0,           NULL          ),
-    SET_INT(    "focus_stealing_prevention",       1,           NULL          ),
-    SET_INT(    "swap_monitors_to_get_tag",        1,           NULL          ),
-    SET_INT(    "raise_on_focus",                  0,           NULL          ),
-    SET_INT(    "raise_on_focus_temporarily",      0,           FOCUS_LAYER   ),
-    SET_INT(    "raise_on_click",                  1,           NULL          ),
-    SET_INT(    "gapless_grid",                    1,           RELAYOUT      ),
-    SET_INT(    "smart_frame_surroundings",        0,           RELAYOUT      ),
-    SET_INT(    "smart_window_surroundings",       0,           RELAYOUT      ),
-    SET_INT(    "monitors_locked",                 0,           LOCK_CHANGED  ),
-    SET_INT(    "auto_detect_monitors",            0,           NULL          ),
-    SET_INT(    "pseudotile_center_threshold",    10,           RELAYOUT      ),
-    SET_INT(    "update_dragged_clients",          0,           NULL          ),
-    SET_STRING( "tree_style",                      "*| +`--.",  reload_tree_style),
-    SET_STRING( "wmname",                  WINDOW_MANAGER_NAME, WMNAME        ),
-    // settings for compatibility:
-    SET_COMPAT( "window_border_width",
-                "theme.tiling.active.border_width", "theme.border_width"),
-    SET_COMPAT( "window_border_inner_width",
-                "theme.tiling.active.inner_width", "theme.inner_width"),
-    SET_COMPAT( "window_border_inner_color",
-                "theme.tiling.active.inner_color", "theme.inner_color"),
-    SET_COMPAT( "window_border_active_color",
-                "theme.tiling.active.color", "theme.active.color"),
-    SET_COMPAT( "window_border_normal_color",
-                "theme.tiling.normal.color", "theme.normal.color"),
-    SET_COMPAT( "window_border_urgent_color",
-                "theme.tiling.urgent.color", "theme.urgent.color"),
+// default settings
+#define HS_SETTING_PAIR(ID, TYPE, NAME, A, B) SET_##TYPE(NAME, A, B),
+SettingsPair g_settings[SETTING_COUNT] = {
+    HS_SETTINGS(HS_SETTING_PAIR)
 };
+#undef HS_SETTING_PAIR
 
 // globals:
 int g_initial_monitors_locked = 0;
 
 // module internals
 static HSObject*       g_settings_object;
+static HSTrie*         g_settings_names; // name -> SettingsPair*
+static int             g_settings_batch_depth = 0;
+static GArray*         g_settings_pending; // distinct HSSettingsCallback
 
 static GString* cb_on_change(HSAttribute* attr);
 static void cb_read_compat(void* data, GString* output);
 static GString* cb_write_compat(HSAttribute* attr, const char* new_value);
 
 void update_verbose() {
-    g_verbose = settings_find("verbose")->value.i;
+    g_verbose = settings_by_id(SETTING_VERBOSE)->value.i;
 }
 
 int settings_count() {
@@ -139,8 +96,13 @@ void settings_init() {
             g_settings[i].old_value_i = 1;
         }
     }
-    settings_find("monitors_locked")->value.i = g_initial_monitors_locked;
-    settings_find("verbose")->value.i = g_verbose;
+    settings_by_id(SETTING_MONITORS_LOCKED)->value.i = g_initial_monitors_locked;
+    settings_by_id(SETTING_VERBOSE)->value.i = g_verbose;
+    g_settings_names = trie_create();
+    for (int i = 0; i < LENGTH(g_settings); i++) {
+        trie_insert(g_settings_names, g_settings[i].name, g_settings + i);
+    }
+    g_settings_pending = g_array_new(false, false, sizeof(HSSettingsCallback));
 
     // create a settings object
     g_settings_object = hsobject_create_and_link(hsobject_root(), "settings");
@@ -177,14 +139,51 @@ void settings_destroy() {
             g_string_free(g_settings[i].value.str, true);
         }
     }
+    trie_destroy(g_settings_names);
+    g_array_free(g_settings_pending, true);
+}
+
+// calls the on_change callback of pair or defers it if a batch is open
+static void settings_changed(SettingsPair* pair) {
+    HSSettingsCallback cb = pair->on_change;
+    if (!cb) {
+        return;
+    }
+    if (g_settings_batch_depth <= 0) {
+        cb();
+        return;
+    }
+    for (int i = 0; i < g_settings_pending->len; i++) {
+        if (g_array_index(g_settings_pending, HSSettingsCallback, i) == cb) {
+            return;
+        }
+    }
+    g_array_append_val(g_settings_pending, cb);
+}
+
+void settings_batch_begin() {
+    g_settings_batch_depth++;
+}
+
+void settings_batch_end() {
+    HSAssert(g_settings_batch_depth > 0);
+    if (--g_settings_batch_depth > 0) {
+        return;
+    }
+    // callbacks may change settings again, so do not iterate over
+    // g_settings_pending directly
+    while (g_settings_pending->len > 0) {
+        HSSettingsCallback cb =
+            g_array_index(g_settings_pending, HSSettingsCallback, 0);
+        g_array_remove_index(g_settings_pending, 0);
+        cb();
+    }
 }
 
 static GString* cb_on_change(HSAttribute* attr) {
     int idx = attr - g_settings_object->attributes;
     HSAssert (idx >= 0 || idx < LENGTH(g_settings));
-    if (g_settings[idx].on_change) {
-        g_settings[idx].on_change();
-    }
+    settings_changed(g_settings + idx);
     return NULL;
 }
 
@@ -205,7 +204,11 @@ static GString* cb_write_compat(HSAttribute* attr, const char* new_value) {
 }
 
 SettingsPair* settings_find(const char* name) {
-    return STATIC_TABLE_FIND_STR(SettingsPair, g_settings, name, name);
+    return (SettingsPair*)trie_lookup(g_settings_names, name);
+}
+
+HSTrie* settings_name_trie() {
+    return g_settings_names;
 }
 
 SettingsPair* settings_get_by_index(int i) {
@@ -271,12 +274,55 @@ int settings_set(SettingsPair* pair, const char* value) {
         return status;
     }
     // on successful change, call callback
-    if (pair->on_change) {
-        pair->on_change();
-    }
+    settings_changed(pair);
     return 0;
 }
 
+// tells if settings_set() accepts value for pair. Values of compatibility
+// settings are only checked by the attribute they are written to.
+static bool settings_value_valid(SettingsPair* pair, const char* value) {
+    int new_value;
+    return pair->type != HS_Int || 1 == sscanf(value, "%d", &new_value);
+}
+
+int settings_set_many_command(int argc, char** argv, GString* output) {
+    if (argc < 3) {
+        return HERBST_NEED_MORE_ARGS;
+    }
+    if (argc % 2 == 0) {
+        g_string_append_printf(output,
+            "%s: Missing value for setting \"%s\"\n", argv[0], argv[argc - 1]);
+        return HERBST_NEED_MORE_ARGS;
+    }
+    // check all names and values before anything is changed
+    for (int i = 1; i < argc; i += 2) {
+        SettingsPair* pair = settings_find(argv[i]);
+        if (!pair) {
+            g_string_append_printf(output,
+                "%s: Setting \"%s\" not found\n", argv[0], argv[i]);
+            return HERBST_SETTING_NOT_FOUND;
+        }
+        if (!settings_value_valid(pair, argv[i + 1])) {
+            g_string_append_printf(output,
+                "%s: Invalid value for setting \"%s\"\n", argv[0], argv[i]);
+            return HERBST_INVALID_ARGUMENT;
+        }
+    }
+    int ret = 0;
+    settings_batch_begin();
+    for (int i = 1; i < argc; i += 2) {
+        ret = settings_set(settings_find(argv[i]), argv[i + 1]);
+        if (ret != 0) {
+            // only compatibility settings can fail here
+            g_string_append_printf(output,
+                "%s: Invalid value for setting \"%s\"\n", argv[0], argv[i]);
+            break;
+        }
+    }
+    settings_batch_end();
+    return ret;
+}
+
 int settings_get(int argc, char** argv, GString* output) {
     if (argc < 2) {
         return HERBST_NEED_MORE_ARGS;
@@ -327,9 +373,7 @@ int settings_toggle(int argc, char** argv, GString* output) {
         return HERBST_INVALID_ARGUMENT;
     }
     // on successful change, call callback
-    if (pair->on_change) {
-        pair->on_change();
-    }
+    settings_changed(pair);
     return 0;
 }
 static bool memberequals_settingspair(void* pmember, const void* needle) {
@@ -8,12 +8,83 @@
 
 #include "glib-backports.h"
 
+struct HSTrie;
+
 enum {
     HS_String = 0,
     HS_Int,
     HS_Compatiblity,
 };
 
+// all settings, in the order of g_settings. For each setting,
+// HS_SETTINGS(X) expands X(ID, TYPE, NAME, A, B), where TYPE is INT, STRING or
+// COMPAT. For INT and STRING, A is the default value and B the callback on
+// change. For COMPAT, A is the attribute that is read and B the attribute
+// that is written.
+#define HS_SETTINGS(X) \
+    X(VERBOSE,                          INT,    "verbose",                           0,           update_verbose) \
+    X(FRAME_GAP,                        INT,    "frame_gap",                         5,           RELAYOUT) \
+    X(FRAME_PADDING,                    INT,    "frame_padding",                     0,           RELAYOUT) \
+    X(WINDOW_GAP,                       INT,    "window_gap",                        0,           RELAYOUT) \
+    X(SNAP_DISTANCE,                    INT,    "snap_distance",                     10,          NULL) \
+    X(SNAP_GAP,                         INT,    "snap_gap",                          5,           NULL) \
+    X(MOUSE_RECENTER_GAP,               INT,    "mouse_recenter_gap",                0,           NULL) \
+    X(FRAME_BORDER_ACTIVE_COLOR,        STRING, "frame_border_active_color",         "red",       FR_COLORS) \
+    X(FRAME_BORDER_NORMAL_COLOR,        STRING, "frame_border_normal_color",         "blue",      FR_COLORS) \
+    X(FRAME_BORDER_INNER_COLOR,         STRING, "frame_border_inner_color",          "black",     FR_COLORS) \
+    X(FRAME_BG_NORMAL_COLOR,            STRING, "frame_bg_normal_color",             "black",     FR_COLORS) \
+    X(FRAME_BG_ACTIVE_COLOR,            STRING, "frame_bg_active_color",             "black",     FR_COLORS) \
+    X(FRAME_BG_TRANSPARENT,             INT,    "frame_bg_transparent",              0,           FR_COLORS) \
+    X(FRAME_TRANSPARENT_WIDTH,          INT,    "frame_transparent_width",           0,           FR_COLORS) \
+    X(FRAME_BORDER_WIDTH,               INT,    "frame_border_width",                2,           FR_COLORS) \
+    X(FRAME_BORDER_INNER_WIDTH,         INT,    "frame_border_inner_width",          0,           FR_COLORS) \
+    X(FRAME_ACTIVE_OPACITY,             INT,    "frame_active_opacity",              100,         FR_COLORS) \
+    X(FRAME_NORMAL_OPACITY,             INT,    "frame_normal_opacity",              100,         FR_COLORS) \
+    X(FOCUS_CROSSES_MONITOR_BOUNDARIES, INT,    "focus_crosses_monitor_boundaries",  1,           NULL) \
+    X(ALWAYS_SHOW_FRAME,                INT,    "always_show_frame",                 0,           RELAYOUT) \
+    X(DEFAULT_DIRECTION_EXTERNAL_ONLY,  INT,    "default_direction_external_only",   0,           NULL) \
+    X(DEFAULT_FRAME_LAYOUT,             INT,    "default_frame_layout",              0,           FR_COLORS) \
+    X(FOCUS_FOLLOWS_MOUSE,              INT,    "focus_follows_mouse",               0,           NULL) \
+    X(FOCUS_STEALING_PREVENTION,        INT,    "focus_stealing_prevention",         1,           NULL) \
+    X(SWAP_MONITORS_TO_GET_TAG,         INT,    "swap_monitors_to_get_tag",          1,           NULL) \
+    X(RAISE_ON_FOCUS,                   INT,    "raise_on_focus",                    0,           NULL) \
+    X(RAISE_ON_FOCUS_TEMPORARILY,       INT,    "raise_on_focus_temporarily",        0,           FOCUS_LAYER) \
+    X(RAISE_ON_CLICK,                   INT,    "raise_on_click",                    1,           NULL) \
+    X(GAPLESS_GRID,                     INT,    "gapless_grid",                      1,           RELAYOUT) \
+    X(SMART_FRAME_SURROUNDINGS,         INT,    "smart_frame_surroundings",          0,           RELAYOUT) \
+    X(SMART_WINDOW_SURROUNDINGS,        INT,    "smart_window_surroundings",         0,           RELAYOUT) \
+    X(MONITORS_LOCKED,                  INT,    "monitors_locked",                   0,           LOCK_CHANGED) \
+    X(AUTO_DETECT_MONITORS,             INT,    "auto_detect_monitors",              0,           NULL) \
+    X(PSEUDOTILE_CENTER_THRESHOLD,      INT,    "pseudotile_center_threshold",       10,          RELAYOUT) \
+    X(UPDATE_DRAGGED_CLIENTS,           INT,    "update_dragged_clients",            0,           NULL) \
+    X(LAYOUT_HISTORY_SIZE,              INT,    "layout_history_size",               20,          NULL) \
+    X(TAG_CONTAINERS,                   INT,    "tag_containers",                    0,           tag_update_containers) \
+    X(TITLE_UPDATE_INTERVAL,            INT,    "title_update_interval",             0,           NULL) \
+    X(FOCUS_FOLLOWS_MOUSE_DELAY,        INT,    "focus_follows_mouse_delay",         0,           NULL) \
+    X(TREE_STYLE,                       STRING, "tree_style",                        "*| +`--.",  reload_tree_style) \
+    X(WMNAME,                           STRING, "wmname",                            WINDOW_MANAGER_NAME, WMNAME) \
+    /* settings for compatibility: */ \
+    X(WINDOW_BORDER_WIDTH,              COMPAT, "window_border_width", \
+      "theme.tiling.active.border_width", "theme.border_width") \
+    X(WINDOW_BORDER_INNER_WIDTH,        COMPAT, "window_border_inner_width", \
+      "theme.tiling.active.inner_width", "theme.inner_width") \
+    X(WINDOW_BORDER_INNER_COLOR,        COMPAT, "window_border_inner_color", \
+      "theme.tiling.active.inner_color", "theme.inner_color") \
+    X(WINDOW_BORDER_ACTIVE_COLOR,       COMPAT, "window_border_active_color", \
+      "theme.tiling.active.color", "theme.active.color") \
+    X(WINDOW_BORDER_NORMAL_COLOR,       COMPAT, "window_border_normal_color", \
+      "theme.tiling.normal.color", "theme.normal.color") \
+    X(WINDOW_BORDER_URGENT_COLOR,       COMPAT, "window_border_urgent_color", \
+      "theme.tiling.urgent.color", "theme.urgent.color")
+
+// handles for the entries of g_settings
+#define HS_SETTING_ID(ID, TYPE, NAME, A, B) SETTING_##ID,
+typedef enum {
+    HS_SETTINGS(HS_SETTING_ID)
+    SETTING_COUNT,
+} HSSettingId;
+#undef HS_SETTING_ID
+
 typedef struct {
     const char*   name;
     union {
@@ -30,17 +101,32 @@ typedef struct {
     void (*on_change)(); // what to call on change
 } SettingsPair;
 
+typedef void (*HSSettingsCallback)();
+
 extern int g_initial_monitors_locked;
+extern SettingsPair g_settings[SETTING_COUNT];
 
 void settings_init();
 void settings_destroy();
 
+// direct access to a setting without looking up its name
+static inline SettingsPair* settings_by_id(HSSettingId id) {
+    return g_settings + id;
+}
+
 SettingsPair* settings_find(const char* name);
+struct HSTrie* settings_name_trie();
 SettingsPair* settings_get_by_index(int i);
 char* settings_find_string(const char* name);
 
+// while a batch is open, each on_change callback is only remembered and
+// called once when the outermost batch ends
+void settings_batch_begin();
+void settings_batch_end();
+
 int settings_set(SettingsPair* pair, const char* value);
 int settings_set_command(int argc, const char** argv, GString* output);
+int settings_set_many_command(int argc, char** argv, GString* output);
 int settings_toggle(int argc, char** argv, GString* output);
 int settings_cycle_value(int argc, char** argv, GString* output);
 int settings_count();
@@ -10,8 +10,9 @@
 #include <assert.h>
 #include <stdbool.h>
 
-static struct HSTreeInterface stack_nth_child(HSTree root, size_t idx);
-static size_t                  stack_child_count(HSTree root);
+static void     stack_foreach_child(HSTree root, HSTreeChildAction action,
+                                    void* data);
+static size_t   stack_child_count(HSTree root);
 
 const std::array<const char*, LAYER_COUNT>g_layer_names =
     ArrayInitializer<const char*, LAYER_COUNT>({
@@ -107,6 +108,21 @@ void stack_remove_slice(HSStack* s, HSSlice* elem) {
     s->dirty = true;
 }
 
+void stack_remove_foreign_slices(HSStack* s, HSTag* tag) {
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        GList* cur = s->top[layer];
+        while (cur) {
+            GList* next = cur->next;
+            HSSlice* slice = (HSSlice*)cur->data;
+            if (slice->type == SLICE_CLIENT && slice->data.client->tag != tag) {
+                s->top[layer] = g_list_delete_link(s->top[layer], cur);
+                s->dirty = true;
+            }
+            cur = next;
+        }
+    }
+}
+
 static void slice_append_caption(HSTree root, GString* output) {
     HSSlice* slice = (HSSlice*)root;
     GString* monitor_name = g_string_new("");
@@ -134,10 +150,11 @@ static void slice_append_caption(HSTree root, GString* output) {
     g_string_free(monitor_name, true);
 }
 
-static struct HSTreeInterface slice_nth_child(HSTree root, size_t idx) {
+static void slice_foreach_child(HSTree root, HSTreeChildAction action,
+                                void* data) {
     HSSlice* slice = (HSSlice*)root;
     assert(slice->type == SLICE_MONITOR);
-    return stack_nth_child(slice->data.monitor->tag->stack, idx);
+    stack_foreach_child(slice->data.monitor->tag->stack, action, data);
 }
 
 static size_t slice_child_count(HSTree root) {
@@ -154,17 +171,20 @@ struct TmpLayer {
     HSLayer    layer;
 };
 
-static struct HSTreeInterface layer_nth_child(HSTree root, size_t idx) {
+static void layer_foreach_child(HSTree root, HSTreeChildAction action,
+                                void* data) {
     struct TmpLayer* l = (struct TmpLayer*) root;
-    HSSlice* slice = (HSSlice*) g_list_nth_data(l->stack->top[l->layer], idx);
     HSTreeInterface intface = {
-        /* .nth_child      = */ slice_nth_child,
+        /* .foreach_child  = */ slice_foreach_child,
         /* .child_count    = */ slice_child_count,
         /* .append_caption = */ slice_append_caption,
-        /* .data           = */ slice,
+        /* .data           = */ NULL,
         /* .destructor     = */ NULL,
     };
-    return intface;
+    for (GList* cur = l->stack->top[l->layer]; cur; cur = cur->next) {
+        intface.data = (HSSlice*) cur->data;
+        action(&intface, data);
+    }
 }
 
 static size_t layer_child_count(HSTree root) {
@@ -178,19 +198,21 @@ static void layer_append_caption(HSTree root, GString* output) {
 }
 
 
-static struct HSTreeInterface stack_nth_child(HSTree root, size_t idx) {
-    struct TmpLayer* l = g_new(struct TmpLayer, 1);
-    l->stack = (HSStack*) root;
-    l->layer = (HSLayer) idx;
-
+static void stack_foreach_child(HSTree root, HSTreeChildAction action,
+                                void* data) {
+    struct TmpLayer l;
+    l.stack = (HSStack*) root;
     HSTreeInterface intface = {
-        /* .nth_child      = */ layer_nth_child,
+        /* .foreach_child  = */ layer_foreach_child,
         /* .child_count    = */ layer_child_count,
         /* .append_caption = */ layer_append_caption,
-        /* .data           = */ l,
-        /* .destructor     = */ (void (*)(HSTree))g_free,
+        /* .data           = */ &l,
+        /* .destructor     = */ NULL,
     };
-    return intface;
+    for (int i = 0; i < LAYER_COUNT; i++) {
+        l.layer = (HSLayer) i;
+        action(&intface, data);
+    }
 }
 
 static size_t stack_child_count(HSTree root) {
@@ -207,7 +229,7 @@ int print_stack_command(int argc, char** argv, GString* output) {
         /* .layer = */ LAYER_NORMAL,
     };
     HSTreeInterface intface = {
-        /* .nth_child      = */ layer_nth_child,
+        /* .foreach_child  = */ layer_foreach_child,
         /* .child_count    = */ layer_child_count,
         /* .append_caption = */ monitor_stack_append_caption,
         /* .data           = */ &tl,
@@ -274,6 +296,17 @@ static void slice_to_window_buf(HSSlice* s, struct s2wb* data) {
                 } else {
                     data->missing++;
                 }
+                if (tag->container) {
+                    // the windows of the tag are stacked within the container
+                    if (data->len) {
+                        data->buf[0] = tag->container;
+                        data->buf++;
+                        data->len--;
+                    } else {
+                        data->missing++;
+                    }
+                    break;
+                }
             }
             int remain_len = 0; /* remaining length */
             stack_to_window_buf(tag->stack, data->buf, data->len,
@@ -343,6 +376,14 @@ void stack_mark_dirty(HSStack* s) {
     s->dirty = true;
 }
 
+void stack_clean(HSStack* s) {
+    s->dirty = false;
+}
+
+bool stack_is_dirty(HSStack* s) {
+    return s->dirty;
+}
+
 void stack_slice_add_layer(HSStack* stack, HSSlice* slice, HSLayer layer) {
     for (int i = 0; i < slice->layer_count; i++) {
         if (slice->layer[i] == layer) {
@@ -391,7 +432,10 @@ Window stack_lowest_window(HSStack* stack) {
                     w = slice->data.window;
                     break;
                 case SLICE_MONITOR:
-                    w = stack_lowest_window(slice->data.monitor->tag->stack);
+                    w = slice->data.monitor->tag->container;
+                    if (!w) {
+                        w = stack_lowest_window(slice->data.monitor->tag->stack);
+                    }
                     break;
             }
             if (w) {
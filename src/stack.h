@@ -59,8 +59,13 @@ HSLayer slice_highest_layer(HSSlice* slice);
 
 void stack_insert_slice(HSStack* s, HSSlice* elem);
 void stack_remove_slice(HSStack* s, HSSlice* elem);
+// removes the slices of all clients that do not belong to tag, in one pass
+void stack_remove_foreign_slices(HSStack* s, struct HSTag* tag);
 void stack_raise_slide(HSStack* stack, HSSlice* slice);
 void stack_mark_dirty(HSStack* s);
+// marks the stack as restacked
+void stack_clean(HSStack* s);
+bool stack_is_dirty(HSStack* s);
 void stack_slice_add_layer(HSStack* stack, HSSlice* slice, HSLayer layer);
 void stack_slice_remove_layer(HSStack* stack, HSSlice* slice, HSLayer layer);
 bool stack_is_layer_empty(HSStack* s, HSLayer layer);
@@ -0,0 +1,209 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#include "state.h"
+
+#include "globals.h"
+#include "ipc-protocol.h"
+#include "utils.h"
+#include "layout.h"
+#include "tag.h"
+#include "monitor.h"
+#include "clientlist.h"
+#include "object.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+static unsigned int g_generation = 1;
+
+void state_init() {
+    HSAttribute attributes[] = {
+        ATTRIBUTE_UINT("generation", g_generation, ATTR_READ_ONLY),
+        ATTRIBUTE_LAST,
+    };
+    hsobject_set_attributes(hsobject_root(), attributes);
+}
+
+void state_destroy() {
+}
+
+unsigned int state_generation() {
+    return g_generation;
+}
+
+void state_changed() {
+    g_generation++;
+}
+
+void state_tag_changed(HSTag* tag) {
+    tag->generation = ++g_generation;
+}
+
+void state_monitor_changed(HSMonitor* monitor) {
+    monitor->generation = ++g_generation;
+}
+
+void state_client_changed(HSClient* client) {
+    client->generation = ++g_generation;
+    if (client->tag) {
+        // the tag dump contains the client
+        client->tag->generation = g_generation;
+    }
+}
+
+static const char* json_bool(bool value) {
+    return value ? "true" : "false";
+}
+
+static void dump_client(HSClient* client, GString* output) {
+    g_string_append_printf(output,
+        "{\"winid\":\"0x%lx\",\"generation\":%u,\"title\":",
+        client->window, client->generation);
+    json_append_string(output, client->title->str);
+    g_string_append_printf(output,
+        ",\"urgent\":%s,\"fullscreen\":%s,\"pseudotile\":%s}",
+        json_bool(client->urgent),
+        json_bool(client->fullscreen),
+        json_bool(client->pseudotile));
+}
+
+// dumps the frame tree including the clients, so everything of a tag is
+// visited exactly once
+static void dump_frame(HSFrame* frame, GString* output) {
+    if (frame->type == TYPE_CLIENTS) {
+        g_string_append_printf(output,
+            "{\"layout\":\"%s\",\"selection\":%d,\"clients\":[",
+            g_layout_names[frame->content.clients.layout],
+            frame->content.clients.selection);
+        for (size_t i = 0; i < frame->content.clients.count; i++) {
+            if (i > 0) {
+                g_string_append_c(output, ',');
+            }
+            dump_client(frame->content.clients.buf[i], output);
+        }
+        g_string_append(output, "]}");
+    } else {
+        HSLayout* layout = &frame->content.layout;
+        g_string_append_printf(output,
+            "{\"split\":\"%s\",\"fraction\":%d,\"selection\":%d,\"a\":",
+            g_align_names[layout->align],
+            layout->fraction,
+            layout->selection);
+        dump_frame(layout->a, output);
+        g_string_append(output, ",\"b\":");
+        dump_frame(layout->b, output);
+        g_string_append_c(output, '}');
+    }
+}
+
+static void dump_tag(HSTag* tag, int index, GString* output) {
+    g_string_append_printf(output, "{\"index\":%d,\"generation\":%u,\"name\":",
+                           index, tag->generation);
+    json_append_string(output, tag->name->str);
+    g_string_append_printf(output,
+        ",\"floating\":%s,\"urgent\":%s,\"client_count\":%d,\"frames\":",
+        json_bool(tag->floating),
+        json_bool(tag->flags & TAG_FLAG_URGENT),
+        tag->client_count);
+    dump_frame(tag->frame, output);
+    g_string_append_c(output, '}');
+}
+
+static void dump_monitor(HSMonitor* monitor, int index, GString* output) {
+    g_string_append_printf(output, "{\"index\":%d,\"generation\":%u,\"name\":",
+                           index, monitor->generation);
+    if (monitor->name) {
+        json_append_string(output, monitor->name->str);
+    } else {
+        g_string_append(output, "null");
+    }
+    g_string_append(output, ",\"tag\":");
+    json_append_string(output, monitor->tag->name->str);
+    g_string_append_printf(output,
+        ",\"rect\":[%d,%d,%d,%d],\"pad\":[%d,%d,%d,%d],\"lock_tag\":%s}",
+        monitor->rect.x, monitor->rect.y,
+        monitor->rect.width, monitor->rect.height,
+        monitor->pad_up, monitor->pad_right,
+        monitor->pad_down, monitor->pad_left,
+        json_bool(monitor->lock_tag));
+}
+
+static void dump_focus(GString* output) {
+    HSMonitor* monitor = get_current_monitor();
+    HSClient* client = get_current_client();
+    g_string_append_printf(output, "{\"monitor\":%d,\"tag\":",
+                           monitor_index_of(monitor));
+    json_append_string(output, monitor->tag->name->str);
+    if (client) {
+        g_string_append_printf(output, ",\"client\":\"0x%lx\"}",
+                               client->window);
+    } else {
+        g_string_append(output, ",\"client\":null}");
+    }
+}
+
+// prints the entire state as one JSON object. If a generation is passed via
+// --since, then only the tags and monitors that changed since then are
+// printed.
+int dump_state_command(int argc, char** argv, GString* output) {
+    unsigned long since = 0;
+    if (argc >= 2) {
+        if (strcmp(argv[1], "--since")) {
+            g_string_append_printf(output,
+                "%s: Unknown argument \"%s\"\n", argv[0], argv[1]);
+            return HERBST_INVALID_ARGUMENT;
+        }
+        if (argc < 3) {
+            return HERBST_NEED_MORE_ARGS;
+        }
+        char* end;
+        since = strtoul(argv[2], &end, 10);
+        if (argv[2][0] == '\0' || *end != '\0') {
+            g_string_append_printf(output,
+                "%s: Invalid generation \"%s\"\n", argv[0], argv[2]);
+            return HERBST_INVALID_ARGUMENT;
+        }
+    }
+    g_string_append_printf(output, "{\"generation\":%u", g_generation);
+    if (since >= g_generation) {
+        g_string_append(output, "}\n");
+        return 0;
+    }
+    tag_update_flags();
+    g_string_append(output, ",\"focus\":");
+    dump_focus(output);
+    g_string_append_printf(output, ",\"tag_count\":%d,\"tags\":[",
+                           tag_get_count());
+    bool first = true;
+    for (int i = 0; i < tag_get_count(); i++) {
+        HSTag* tag = get_tag_by_index(i);
+        if (tag->generation <= since) {
+            continue;
+        }
+        if (!first) {
+            g_string_append_c(output, ',');
+        }
+        first = false;
+        dump_tag(tag, i, output);
+    }
+    g_string_append_printf(output, "],\"monitor_count\":%d,\"monitors\":[",
+                           monitor_count());
+    first = true;
+    for (int i = 0; i < monitor_count(); i++) {
+        HSMonitor* monitor = monitor_with_index(i);
+        if (monitor->generation <= since) {
+            continue;
+        }
+        if (!first) {
+            g_string_append_c(output, ',');
+        }
+        first = false;
+        dump_monitor(monitor, i, output);
+    }
+    g_string_append(output, "]}\n");
+    return 0;
+}
+
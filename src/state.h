@@ -0,0 +1,31 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#ifndef __HERBSTLUFT_STATE_H_
+#define __HERBSTLUFT_STATE_H_
+
+#include "glib-backports.h"
+
+struct HSTag;
+struct HSMonitor;
+struct HSClient;
+
+void state_init();
+void state_destroy();
+
+// the global generation is increased whenever the state of the window
+// manager, that is tags, monitors, frames, clients or the focus, changes.
+// Tags, monitors and clients remember the global generation of their last
+// change, so a poller only needs to compare them to the last value it saw.
+unsigned int state_generation();
+void state_changed();
+void state_tag_changed(struct HSTag* tag); // also for changes of its frames
+void state_monitor_changed(struct HSMonitor* monitor);
+void state_client_changed(struct HSClient* client); // also marks its tag
+
+int dump_state_command(int argc, char** argv, GString* output);
+
+#endif
+
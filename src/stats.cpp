@@ -0,0 +1,421 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#include "stats.h"
+
+#include "globals.h"
+#include "utils.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char* g_event_names[] = {
+    NULL, NULL, "KeyPress", "KeyRelease", "ButtonPress", "ButtonRelease",
+    "MotionNotify", "EnterNotify", "LeaveNotify", "FocusIn", "FocusOut",
+    "KeymapNotify", "Expose", "GraphicsExpose", "NoExpose",
+    "VisibilityNotify", "CreateNotify", "DestroyNotify", "UnmapNotify",
+    "MapNotify", "MapRequest", "ReparentNotify", "ConfigureNotify",
+    "ConfigureRequest", "GravityNotify", "ResizeRequest", "CirculateNotify",
+    "CirculateRequest", "PropertyNotify", "SelectionClear",
+    "SelectionRequest", "SelectionNotify", "ColormapNotify", "ClientMessage",
+    "MappingNotify", "GenericEvent",
+    "Extension", // for all events of extensions
+};
+#define STATS_EXTENSION_EVENT (LENGTH(g_event_names) - 1)
+
+static HSObject*        g_stats_object;
+static HSObject*        g_event_object;
+static HSObject*        g_command_object;
+static HSObject*        g_x11_object;
+static GArray*          g_x11_subsystems; // of HSXSubsystem*
+static HSStatsEntry*    g_event_stats[LENGTH(g_event_names)];
+static GHashTable*      g_command_stats; // command name -> HSStatsEntry*
+static HSStatsEntry*    g_tag_switch_stats;
+static unsigned int     g_slow_threshold = 0; // in usec, 0 to disable
+// the sum over all events
+static unsigned int     g_event_count = 0;
+static gint64           g_event_usec = 0;
+static unsigned int     g_event_requests = 0;
+static unsigned int     g_event_round_trips = 0;
+// the number of all blocking X calls so far, never reset
+static unsigned int     g_round_trips = 0;
+// the blocking X call currently running
+static HSXCallSite*     g_round_trip_site = NULL;
+static gint64           g_round_trip_begin;
+static unsigned long    g_round_trip_request;
+static unsigned int     g_suppressed_title_updates = 0;
+static bool             g_reset = false;
+static int              g_command_depth = 0;
+// the top level commands called during the current event
+static GString*         g_event_commands;
+
+static GString* stats_attr_reset(HSAttribute* attr);
+static HSStatsEntry* stats_entry_create(HSObject* parent, const char* name);
+static void stats_attr_event_usec(void* data, GString* output);
+static void stats_attr_total_usec(void* data, GString* output);
+static void stats_attr_histogram(void* data, GString* output);
+static void stats_attr_subsystem_usec(void* data, GString* output);
+
+void stats_init() {
+    g_stats_object = hsobject_create_and_link(hsobject_root(), "stats");
+    HSAttribute attributes[] = {
+        ATTRIBUTE_UINT("slow_event_threshold", g_slow_threshold, ATTR_ACCEPT_ALL),
+        ATTRIBUTE_BOOL("reset",                g_reset,          stats_attr_reset),
+        ATTRIBUTE_UINT("count",                g_event_count,    ATTR_READ_ONLY),
+        ATTRIBUTE_CUSTOM("total_usec",         stats_attr_event_usec, ATTR_READ_ONLY),
+        ATTRIBUTE_UINT("requests",             g_event_requests, ATTR_READ_ONLY),
+        ATTRIBUTE_UINT("round_trips",          g_event_round_trips, ATTR_READ_ONLY),
+        ATTRIBUTE_UINT("suppressed_title_updates", g_suppressed_title_updates,
+                       ATTR_READ_ONLY),
+        ATTRIBUTE_LAST,
+    };
+    hsobject_set_attributes(g_stats_object, attributes);
+    hsobject_set_attributes_always_callback(g_stats_object);
+    g_event_object = hsobject_create_and_link(g_stats_object, "events");
+    g_command_object = hsobject_create_and_link(g_stats_object, "commands");
+    g_x11_object = hsobject_create_and_link(g_stats_object, "x11");
+    g_x11_subsystems = g_array_new(false, false, sizeof(HSXSubsystem*));
+    g_command_stats = g_hash_table_new(g_str_hash, g_str_equal);
+    g_tag_switch_stats = stats_entry_create(g_stats_object, "tag_switch");
+    g_event_commands = g_string_new("");
+}
+
+static void stats_entry_free(HSStatsEntry* entry) {
+    hsobject_free(&entry->object);
+    g_free(entry);
+}
+
+static void stats_command_entry_free(gpointer key, gpointer entry, gpointer data) {
+    stats_entry_free((HSStatsEntry*)entry);
+}
+
+void stats_destroy() {
+    for (int i = 0; i < LENGTH(g_event_stats); i++) {
+        if (g_event_stats[i]) {
+            stats_entry_free(g_event_stats[i]);
+        }
+    }
+    g_hash_table_foreach(g_command_stats, stats_command_entry_free, NULL);
+    g_hash_table_destroy(g_command_stats);
+    stats_entry_free(g_tag_switch_stats);
+    for (int i = 0; i < g_x11_subsystems->len; i++) {
+        HSXSubsystem* sub = g_array_index(g_x11_subsystems, HSXSubsystem*, i);
+        // the call sites are static, so only detach them
+        for (HSXCallSite* site = sub->sites; site; site = site->next) {
+            site->subsystem = NULL;
+            site->function = NULL;
+        }
+        hsobject_free(&sub->object);
+        g_free(sub->name);
+        g_free(sub);
+    }
+    g_array_free(g_x11_subsystems, true);
+    g_string_free(g_event_commands, true);
+    hsobject_unlink_and_destroy(g_stats_object, g_event_object);
+    hsobject_unlink_and_destroy(g_stats_object, g_command_object);
+    hsobject_unlink_and_destroy(g_stats_object, g_x11_object);
+    hsobject_unlink_and_destroy(hsobject_root(), g_stats_object);
+    g_stats_object = NULL;
+}
+
+static HSStatsEntry* stats_entry_create(HSObject* parent, const char* name) {
+    HSStatsEntry* entry = g_new0(HSStatsEntry, 1);
+    hsobject_init(&entry->object);
+    entry->object.data = entry;
+    HSAttribute attributes[] = {
+        ATTRIBUTE_UINT(  "count",       entry->count,           ATTR_READ_ONLY),
+        ATTRIBUTE_CUSTOM("total_usec",  stats_attr_total_usec,  ATTR_READ_ONLY),
+        ATTRIBUTE_UINT(  "max_usec",    entry->max_usec,        ATTR_READ_ONLY),
+        ATTRIBUTE_UINT(  "requests",    entry->requests,        ATTR_READ_ONLY),
+        ATTRIBUTE_UINT(  "round_trips", entry->round_trips,     ATTR_READ_ONLY),
+        ATTRIBUTE_CUSTOM("histogram",   stats_attr_histogram,   ATTR_READ_ONLY),
+        ATTRIBUTE_LAST,
+    };
+    hsobject_set_attributes(&entry->object, attributes);
+    hsobject_link(parent, &entry->object, name);
+    return entry;
+}
+
+static void stats_attr_event_usec(void* data, GString* output) {
+    g_string_append_printf(output, "%" G_GINT64_FORMAT, g_event_usec);
+}
+
+static void stats_attr_total_usec(void* data, GString* output) {
+    HSStatsEntry* entry = (HSStatsEntry*) data;
+    g_string_append_printf(output, "%" G_GINT64_FORMAT, entry->total_usec);
+}
+
+static void stats_attr_histogram(void* data, GString* output) {
+    HSStatsEntry* entry = (HSStatsEntry*) data;
+    for (int i = 0; i < STATS_BUCKET_COUNT; i++) {
+        g_string_append_printf(output, i ? " %u" : "%u", entry->histogram[i]);
+    }
+}
+
+static void stats_attr_subsystem_usec(void* data, GString* output) {
+    HSXSubsystem* sub = (HSXSubsystem*) data;
+    g_string_append_printf(output, "%" G_GINT64_FORMAT, sub->usec);
+}
+
+static void stats_entry_reset(HSStatsEntry* entry) {
+    entry->count = 0;
+    entry->total_usec = 0;
+    entry->max_usec = 0;
+    entry->requests = 0;
+    entry->round_trips = 0;
+    memset(entry->histogram, 0, sizeof(entry->histogram));
+}
+
+static void stats_command_entry_reset(gpointer key, gpointer entry, gpointer data) {
+    stats_entry_reset((HSStatsEntry*)entry);
+}
+
+static GString* stats_attr_reset(HSAttribute* attr) {
+    if (g_reset) {
+        for (int i = 0; i < LENGTH(g_event_stats); i++) {
+            if (g_event_stats[i]) {
+                stats_entry_reset(g_event_stats[i]);
+            }
+        }
+        g_hash_table_foreach(g_command_stats, stats_command_entry_reset, NULL);
+        stats_entry_reset(g_tag_switch_stats);
+        g_event_count = 0;
+        g_event_usec = 0;
+        g_event_requests = 0;
+        g_event_round_trips = 0;
+        g_suppressed_title_updates = 0;
+        for (int i = 0; i < g_x11_subsystems->len; i++) {
+            HSXSubsystem* sub =
+                g_array_index(g_x11_subsystems, HSXSubsystem*, i);
+            sub->round_trips = 0;
+            sub->requests = 0;
+            sub->usec = 0;
+            for (HSXCallSite* site = sub->sites; site; site = site->next) {
+                site->round_trips = 0;
+                site->requests = 0;
+                site->usec = 0;
+            }
+        }
+        g_reset = false;
+    }
+    return NULL;
+}
+
+// adds a finished measurement to entry and returns its duration in usec
+static gint64 stats_entry_add(HSStatsEntry* entry, HSStatsMeasure* m,
+                              unsigned long* requests,
+                              unsigned int* round_trips) {
+    static const gint64 bounds[] = STATS_BUCKET_BOUNDS;
+    gint64 duration = get_monotonic_usec() - m->begin;
+    *requests = NextRequest(g_display) - m->request;
+    *round_trips = g_round_trips - m->round_trips;
+    int bucket = 0;
+    while (bucket < LENGTH(bounds) && duration >= bounds[bucket]) {
+        bucket++;
+    }
+    entry->count++;
+    entry->total_usec += duration;
+    entry->max_usec = MAX(entry->max_usec, (unsigned int)duration);
+    entry->requests += *requests;
+    entry->round_trips += *round_trips;
+    entry->histogram[bucket]++;
+    return duration;
+}
+
+void stats_event_begin(HSStatsMeasure* m) {
+    m->begin = get_monotonic_usec();
+    m->request = NextRequest(g_display);
+    m->round_trips = g_round_trips;
+    g_string_truncate(g_event_commands, 0);
+}
+
+void stats_event_end(HSStatsMeasure* m, XEvent* event) {
+    int type = event->type;
+    if (type < 2 || type >= STATS_EXTENSION_EVENT) {
+        type = STATS_EXTENSION_EVENT;
+    }
+    if (!g_event_stats[type]) {
+        g_event_stats[type] =
+            stats_entry_create(g_event_object, g_event_names[type]);
+    }
+    unsigned long requests;
+    unsigned int round_trips;
+    gint64 duration = stats_entry_add(g_event_stats[type], m,
+                                      &requests, &round_trips);
+    g_event_count++;
+    g_event_usec += duration;
+    g_event_requests += requests;
+    g_event_round_trips += round_trips;
+    if (g_slow_threshold > 0 && duration >= g_slow_threshold) {
+        fprintf(stderr,
+                "herbstluftwm: slow %s on window 0x%lx: %.3f ms, "
+                "%lu requests, %u round trips%s%s\n",
+                g_event_names[type], event->xany.window, duration / 1000.0,
+                requests, round_trips,
+                g_event_commands->len ? ", commands: " : "",
+                g_event_commands->str);
+    }
+}
+
+void stats_command_begin(HSStatsMeasure* m) {
+    g_command_depth++;
+    m->begin = get_monotonic_usec();
+    m->request = NextRequest(g_display);
+    m->round_trips = g_round_trips;
+}
+
+void stats_command_end(HSStatsMeasure* m, const char* name,
+                       int argc, char** argv) {
+    g_command_depth--;
+    HSStatsEntry* entry =
+        (HSStatsEntry*) g_hash_table_lookup(g_command_stats, name);
+    if (!entry) {
+        entry = stats_entry_create(g_command_object, name);
+        g_hash_table_insert(g_command_stats, (gpointer)name, entry);
+    }
+    unsigned long requests;
+    unsigned int round_trips;
+    stats_entry_add(entry, m, &requests, &round_trips);
+    if (g_command_depth == 0 && g_slow_threshold > 0) {
+        // remember the command line for the slow event log
+        if (g_event_commands->len) {
+            g_string_append(g_event_commands, "; ");
+        }
+        for (int i = 0; i < argc; i++) {
+            g_string_append(g_event_commands, i ? " " : "");
+            g_string_append(g_event_commands, argv[i]);
+        }
+    }
+}
+
+
+void stats_tag_switch_begin(HSStatsMeasure* m) {
+    m->begin = get_monotonic_usec();
+    m->request = NextRequest(g_display);
+    m->round_trips = g_round_trips;
+}
+
+void stats_tag_switch_end(HSStatsMeasure* m) {
+    unsigned long requests;
+    unsigned int round_trips;
+    stats_entry_add(g_tag_switch_stats, m, &requests, &round_trips);
+}
+
+void stats_title_update_suppressed() {
+    g_suppressed_title_updates++;
+}
+
+static HSXSubsystem* stats_subsystem_get(const char* file) {
+    // the subsystem is the file name without directory and extension
+    const char* name = strrchr(file, '/');
+    name = name ? name + 1 : file;
+    const char* ext = strchr(name, '.');
+    size_t len = ext ? (size_t)(ext - name) : strlen(name);
+    for (int i = 0; i < g_x11_subsystems->len; i++) {
+        HSXSubsystem* sub = g_array_index(g_x11_subsystems, HSXSubsystem*, i);
+        if (strlen(sub->name) == len && !strncmp(sub->name, name, len)) {
+            return sub;
+        }
+    }
+    HSXSubsystem* sub = g_new0(HSXSubsystem, 1);
+    sub->name = g_strndup(name, len);
+    hsobject_init(&sub->object);
+    sub->object.data = sub;
+    HSAttribute attributes[] = {
+        ATTRIBUTE_UINT(  "round_trips", sub->round_trips,           ATTR_READ_ONLY),
+        ATTRIBUTE_UINT(  "requests",    sub->requests,              ATTR_READ_ONLY),
+        ATTRIBUTE_CUSTOM("usec",        stats_attr_subsystem_usec,  ATTR_READ_ONLY),
+        ATTRIBUTE_LAST,
+    };
+    hsobject_set_attributes(&sub->object, attributes);
+    hsobject_link(g_x11_object, &sub->object, sub->name);
+    g_array_append_val(g_x11_subsystems, sub);
+    return sub;
+}
+
+void stats_round_trip_begin(HSXCallSite* site, const char* function) {
+    if (!g_stats_object) {
+        // X calls during the initialization of earlier modules
+        return;
+    }
+    if (!site->subsystem) {
+        HSXSubsystem* sub = stats_subsystem_get(site->file);
+        site->function = function;
+        site->subsystem = sub;
+        site->next = sub->sites;
+        sub->sites = site;
+    }
+    g_round_trip_site = site;
+    g_round_trip_request = NextRequest(g_display);
+    g_round_trip_begin = get_monotonic_usec();
+}
+
+void stats_round_trip_end() {
+    HSXCallSite* site = g_round_trip_site;
+    if (!site) {
+        return;
+    }
+    g_round_trip_site = NULL;
+    gint64 duration = get_monotonic_usec() - g_round_trip_begin;
+    unsigned int requests = NextRequest(g_display) - g_round_trip_request;
+    g_round_trips++;
+    site->round_trips++;
+    site->requests += requests;
+    site->usec += duration;
+    site->subsystem->round_trips++;
+    site->subsystem->requests += requests;
+    site->subsystem->usec += duration;
+}
+
+// sorts by round trips, most frequent first
+static gint subsystem_compare(gconstpointer a, gconstpointer b) {
+    const HSXSubsystem* sa = *(const HSXSubsystem* const*)a;
+    const HSXSubsystem* sb = *(const HSXSubsystem* const*)b;
+    return (sa->round_trips < sb->round_trips)
+         - (sa->round_trips > sb->round_trips);
+}
+
+static gint call_site_compare(gconstpointer a, gconstpointer b) {
+    const HSXCallSite* sa = *(const HSXCallSite* const*)a;
+    const HSXCallSite* sb = *(const HSXCallSite* const*)b;
+    return (sa->round_trips < sb->round_trips)
+         - (sa->round_trips > sb->round_trips);
+}
+
+int profile_command(int argc, char** argv, GString* output) {
+    GArray* subsystems = g_array_sized_new(false, false, sizeof(HSXSubsystem*),
+                                           g_x11_subsystems->len);
+    g_array_append_vals(subsystems, g_x11_subsystems->data,
+                        g_x11_subsystems->len);
+    g_array_sort(subsystems, subsystem_compare);
+    GArray* sites = g_array_new(false, false, sizeof(HSXCallSite*));
+    g_string_append(output, "round_trips requests     usec  site\n");
+    for (int i = 0; i < subsystems->len; i++) {
+        HSXSubsystem* sub = g_array_index(subsystems, HSXSubsystem*, i);
+        if (sub->round_trips == 0) {
+            continue;
+        }
+        g_string_append_printf(output,
+            "%11u %8u %8" G_GINT64_FORMAT "  %s\n",
+            sub->round_trips, sub->requests, sub->usec, sub->name);
+        g_array_set_size(sites, 0);
+        for (HSXCallSite* site = sub->sites; site; site = site->next) {
+            if (site->round_trips > 0) {
+                g_array_append_val(sites, site);
+            }
+        }
+        g_array_sort(sites, call_site_compare);
+        for (int j = 0; j < sites->len; j++) {
+            HSXCallSite* site = g_array_index(sites, HSXCallSite*, j);
+            g_string_append_printf(output,
+                "%11u %8u %8" G_GINT64_FORMAT "    %s:%d %s\n",
+                site->round_trips, site->requests, site->usec,
+                sub->name, site->line, site->function);
+        }
+    }
+    g_array_free(sites, true);
+    g_array_free(subsystems, true);
+    return 0;
+}
@@ -0,0 +1,83 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#ifndef __HERBSTLUFT_STATS_H_
+#define __HERBSTLUFT_STATS_H_
+
+#include "glib-backports.h"
+#include "object.h"
+#include <stdbool.h>
+#include <X11/Xlib.h>
+
+// upper bounds of the histogram buckets in microseconds, the last bucket
+// holds everything above
+#define STATS_BUCKET_BOUNDS { 100, 1000, 10000, 100000 }
+#define STATS_BUCKET_COUNT 5
+
+// the statistics of one event type or one command
+typedef struct HSStatsEntry {
+    unsigned int    count;      // number of calls
+    gint64          total_usec; // wall time of all calls
+    unsigned int    max_usec;   // wall time of the slowest call
+    unsigned int    requests;   // X requests issued by all calls
+    unsigned int    round_trips; // blocking X calls of all calls
+    unsigned int    histogram[STATS_BUCKET_COUNT];
+    HSObject        object;
+} HSStatsEntry;
+
+// a running measurement of an event handler or a command
+typedef struct HSStatsMeasure {
+    gint64          begin;
+    unsigned long   request; // serial of the next X request at begin
+    unsigned int    round_trips; // value of the round trip counter at begin
+} HSStatsMeasure;
+
+// the round trips of all call sites in one source file
+typedef struct HSXSubsystem {
+    char*                   name; // the file name without extension
+    unsigned int            round_trips;
+    unsigned int            requests;
+    gint64                  usec;
+    struct HSXCallSite*     sites;
+    HSObject                object;
+} HSXSubsystem;
+
+// a place in the code issuing a blocking X call, see X11_ROUND_TRIP()
+typedef struct HSXCallSite {
+    const char*             file;
+    int                     line;
+    const char*             function; // NULL until the first call
+    unsigned int            round_trips;
+    unsigned int            requests; // requests issued by the calls
+    gint64                  usec;     // time spent waiting for the replies
+    HSXSubsystem*           subsystem;
+    struct HSXCallSite*     next;     // next site of the same subsystem
+} HSXCallSite;
+
+void stats_init();
+void stats_destroy();
+
+// measure the handling of an X event
+void stats_event_begin(HSStatsMeasure* m);
+void stats_event_end(HSStatsMeasure* m, XEvent* event);
+// measure a command, name must live as long as the command binding
+void stats_command_begin(HSStatsMeasure* m);
+void stats_command_end(HSStatsMeasure* m, const char* name,
+                       int argc, char** argv);
+// measure switching the tag of a monitor
+void stats_tag_switch_begin(HSStatsMeasure* m);
+void stats_tag_switch_end(HSStatsMeasure* m);
+// count a title change that did not cause an update of its own
+void stats_title_update_suppressed();
+
+// account a blocking X call at site, must be followed by
+// stats_round_trip_end() right after the call returned
+void stats_round_trip_begin(HSXCallSite* site, const char* function);
+void stats_round_trip_end();
+
+int profile_command(int argc, char** argv, GString* output);
+
+#endif
+
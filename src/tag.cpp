@@ -19,19 +19,29 @@
 #include "ewmh.h"
 #include "monitor.h"
 #include "settings.h"
+#include "history.h"
+#include "trie.h"
+#include "state.h"
+#include "x11-utils.h"
+#include "rules.h"
 
 static GArray*     g_tags; // Array of HSTag*
 static bool    g_tag_flags_dirty = true;
 static HSObject* g_tag_object;
 static HSObject* g_tag_by_name;
+static HSTrie* g_tag_names; // tag name -> HSTag*
 static int* g_raise_on_focus_temporarily;
+static int* g_tag_containers;
 
 static int tag_rename(HSTag* tag, char* name, GString* output);
+static void tag_container_create(HSTag* tag);
 
 void tag_init() {
     g_tags = g_array_new(false, false, sizeof(HSTag*));
-    g_raise_on_focus_temporarily = &(settings_find("raise_on_focus_temporarily")
+    g_tag_names = trie_create();
+    g_raise_on_focus_temporarily = &(settings_by_id(SETTING_RAISE_ON_FOCUS_TEMPORARILY)
                                      ->value.i);
+    g_tag_containers = &(settings_by_id(SETTING_TAG_CONTAINERS)->value.i);
     g_tag_object = hsobject_create_and_link(hsobject_root(), "tags");
     HSAttribute attributes[] = {
         ATTRIBUTE("count", g_tags->len, ATTR_READ_ONLY),
@@ -50,7 +60,13 @@ static void tag_free(HSTag* tag) {
             g_free(buf);
         }
     }
+    if (tag->container) {
+        // all frames are destroyed and all clients are moved away already
+        XDestroyWindow(g_display, tag->container);
+    }
     stack_destroy(tag->stack);
+    history_free(tag->history);
+    trie_remove(g_tag_names, tag->name->str);
     hsobject_unlink_and_destroy(g_tag_by_name, tag->object);
     g_string_free(tag->name, true);
     g_string_free(tag->display_name, true);
@@ -64,6 +80,7 @@ void tag_destroy() {
         tag_free(tag);
     }
     g_array_free(g_tags, true);
+    trie_destroy(g_tag_names);
     hsobject_unlink_and_destroy(g_tag_object, g_tag_by_name);
     hsobject_unlink_and_destroy(hsobject_root(), g_tag_object);
 }
@@ -73,13 +90,11 @@ int    tag_get_count() {
 }
 
 HSTag* find_tag(const char* name) {
-    int i;
-    for (i = 0; i < g_tags->len; i++) {
-        if (!strcmp(g_array_index(g_tags, HSTag*, i)->name->str, name)) {
-            return g_array_index(g_tags, HSTag*, i);
-        }
-    }
-    return NULL;
+    return (HSTag*)trie_lookup(g_tag_names, name);
+}
+
+HSTrie* tag_name_trie() {
+    return g_tag_names;
 }
 
 int tag_index_of(HSTag* tag) {
@@ -142,6 +157,7 @@ HSTag* find_unused_tag() {
 
 static GString* tag_attr_floating(HSAttribute* attr) {
     HSTag* tag = container_of(attr->value.b, HSTag, floating);
+    state_tag_changed(tag);
     HSMonitor* m = find_monitor_with_tag(tag);
     if (m != NULL) {
         monitor_apply_layout(m);
@@ -161,32 +177,6 @@ static GString* tag_attr_name(HSAttribute* attr) {
     }
 }
 
-static void sum_up_clientframes(HSFrame* frame, void* data) {
-    if (frame->type == TYPE_CLIENTS) {
-        (*(int*)data)++;
-    }
-}
-
-static int tag_attr_frame_count(void* data) {
-    HSTag* tag = (HSTag*) data;
-    int i = 0;
-    frame_do_recursive_data(tag->frame, sum_up_clientframes, 0, &i);
-    return i;
-}
-
-static void sum_up_clients(HSFrame* frame, void* data) {
-    if (frame->type == TYPE_CLIENTS) {
-        *(int*)data += frame->content.clients.count;
-    }
-}
-
-static int tag_attr_client_count(void* data) {
-    HSTag* tag = (HSTag*) data;
-    int i = 0;
-    frame_do_recursive_data(tag->frame, sum_up_clients, 0, &i);
-    return i;
-}
-
 
 static int tag_attr_curframe_windex(void* data) {
     HSTag* tag = (HSTag*) data;
@@ -217,6 +207,8 @@ static void tag_link_id_object(HSTag* tag, void* data) {
     g_string_printf(index_str, "%d", index);
     hsobject_link(g_tag_object, tag->object, index_str->str);
     g_string_free(index_str, true);
+    // the index is part of the tag state
+    state_tag_changed(tag);
 }
 
 HSTag* add_tag(const char* name) {
@@ -227,11 +219,16 @@ HSTag* add_tag(const char* name) {
     }
     HSTag* tag = g_new0(HSTag, 1);
     tag->stack = stack_create();
+    if (*g_tag_containers) {
+        tag_container_create(tag);
+    }
     tag->frame = frame_create_empty(NULL, tag);
     tag->name = g_string_new(name);
     tag->display_name = g_string_new(name);
     tag->floating = false;
+    tag->history = history_create();
     g_array_append_val(g_tags, tag);
+    trie_insert(g_tag_names, name, tag);
 
     // create object
     tag->object = hsobject_create_and_link(g_tag_by_name, name);
@@ -240,10 +237,12 @@ HSTag* add_tag(const char* name) {
         ATTRIBUTE_STRING("name",           tag->display_name,        tag_attr_name),
         ATTRIBUTE_BOOL(  "floating",       tag->floating,            tag_attr_floating),
         ATTRIBUTE_CUSTOM_INT("index",          tag_attr_index,           ATTR_READ_ONLY),
-        ATTRIBUTE_CUSTOM_INT("frame_count",    tag_attr_frame_count,     ATTR_READ_ONLY),
-        ATTRIBUTE_CUSTOM_INT("client_count",   tag_attr_client_count,    ATTR_READ_ONLY),
+        ATTRIBUTE(       "frame_count",    tag->frame_count,         ATTR_READ_ONLY),
+        ATTRIBUTE(       "client_count",   tag->client_count,        ATTR_READ_ONLY),
+        ATTRIBUTE(       "urgent_count",   tag->urgent_count,        ATTR_READ_ONLY),
         ATTRIBUTE_CUSTOM_INT("curframe_windex",tag_attr_curframe_windex, ATTR_READ_ONLY),
         ATTRIBUTE_CUSTOM_INT("curframe_wcount",tag_attr_curframe_wcount, ATTR_READ_ONLY),
+        ATTRIBUTE_UINT(  "generation",     tag->generation,          ATTR_READ_ONLY),
         ATTRIBUTE_LAST,
     };
     hsobject_set_attributes(tag->object, attributes);
@@ -276,8 +275,11 @@ static int tag_rename(HSTag* tag, char* name, GString* output) {
         return HERBST_TAG_IN_USE;
     }
     hsobject_link_rename(g_tag_by_name, tag->name->str, name);
+    trie_remove(g_tag_names, tag->name->str);
+    trie_insert(g_tag_names, name, tag);
     g_string_assign(tag->name, name);
     g_string_assign(tag->display_name, name);
+    state_tag_changed(tag);
     ewmh_update_desktop_names();
     hook_emit_list("tag_renamed", tag->name->str, NULL);
     return 0;
@@ -301,13 +303,23 @@ int tag_rename_command(int argc, char** argv, GString* output) {
     return tag_rename(tag, argv[2], output);
 }
 
-static void client_update_tag(void* key, void* client_void, void* data) {
-    (void) key;
-    (void) data;
-    HSClient* client = (HSClient*)client_void;
-    if (client) {
-        ewmh_window_update_tag(client->window, client->tag);
+static int client_update_desktop(HSClient* client, void* data) {
+    ewmh_window_update_desktop(client->window, *(int*)data);
+    return 0;
+}
+
+// moves clients, which are not part of any frame anymore, into target
+static void tag_insert_clients(HSClient** clients, size_t count, HSTag* target) {
+    int index = tag_index_of(target);
+    for (size_t i = 0; i < count; i++) {
+        HSClient* client = clients[i];
+        client->tag = target;
+        client_update_container(client);
+        state_client_changed(client);
+        stack_insert_slice(target->stack, client->slice);
+        ewmh_window_update_desktop(client->window, index);
     }
+    frame_insert_clients(target->frame, clients, count);
 }
 
 int tag_remove_command(int argc, char** argv, GString* output) {
@@ -344,38 +356,33 @@ int tag_remove_command(int argc, char** argv, GString* output) {
     size_t count;
     frame_destroy(tag->frame, &buf, &count);
     tag->frame = NULL;
-    int i;
-    for (i = 0; i < count; i++) {
-        HSClient* client = buf[i];
-        stack_remove_slice(client->tag->stack, client->slice);
-        client->tag = target;
-        stack_insert_slice(client->tag->stack, client->slice);
-        ewmh_window_update_tag(client->window, client->tag);
-        frame_insert_client(target->frame, buf[i]);
-    }
+    tag_insert_clients(buf, count, target);
+    stack_remove_foreign_slices(tag->stack, tag);
     HSMonitor* monitor_target = find_monitor_with_tag(target);
     if (monitor_target) {
         // if target monitor is viewed, then show windows
         monitor_apply_layout(monitor_target);
-        for (i = 0; i < count; i++) {
+        client_visibility_begin();
+        for (int i = 0; i < count; i++) {
             client_set_visible(buf[i], true);
         }
+        client_visibility_end();
     }
     g_free(buf);
     tag_foreach(tag_unlink_id_object, NULL);
     // remove tag
     char* oldname = g_strdup(tag->name->str);
+    int removed_index = tag_index_of(tag);
     tag_free(tag);
-    for (i = 0; i < g_tags->len; i++) {
-        if (g_array_index(g_tags, HSTag*, i) == tag) {
-            g_array_remove_index(g_tags, i);
-            break;
-        }
-    }
+    g_array_remove_index(g_tags, removed_index);
     ewmh_update_current_desktop();
     ewmh_update_desktops();
     ewmh_update_desktop_names();
-    clientlist_foreach(client_update_tag, NULL);
+    // only the desktop index of clients on the following tags changed
+    for (int i = removed_index; i < g_tags->len; i++) {
+        frame_foreach_client(g_array_index(g_tags, HSTag*, i)->frame,
+                             client_update_desktop, &i);
+    }
     tag_update_focus_objects();
     tag_set_flags_dirty();
     hook_emit_list("tag_removed", oldname, target->name->str, NULL);
@@ -407,6 +414,7 @@ int tag_set_floating_command(int argc, char** argv, GString* output) {
     } else {
         // assign new value and rearrange if needed
         tag->floating = new_value;
+        state_tag_changed(tag);
 
         HSMonitor* m = find_monitor_with_tag(tag);
         HSDebug("setting tag:%s->floating to %s\n", tag->name->str, tag->floating ? "on" : "off");
@@ -417,26 +425,19 @@ int tag_set_floating_command(int argc, char** argv, GString* output) {
     return 0;
 }
 
-static void client_update_tag_flags(void* key, void* client_void, void* data) {
-    (void) key;
-    (void) data;
-    HSClient* client = (HSClient*)client_void;
-    if (client) {
-        TAG_SET_FLAG(client->tag, TAG_FLAG_USED);
-        if (client->urgent) {
-            TAG_SET_FLAG(client->tag, TAG_FLAG_URGENT);
-        }
-    }
-}
-
 void tag_force_update_flags() {
     g_tag_flags_dirty = false;
-    // unset all tags
+    // the flags are derived from the counters maintained by the frames
     for (int i = 0; i < g_tags->len; i++) {
-        g_array_index(g_tags, HSTag*, i)->flags = 0;
+        HSTag* tag = g_array_index(g_tags, HSTag*, i);
+        tag->flags = 0;
+        if (tag->client_count > 0) {
+            TAG_SET_FLAG(tag, TAG_FLAG_USED);
+        }
+        if (tag->urgent_count > 0) {
+            TAG_SET_FLAG(tag, TAG_FLAG_URGENT);
+        }
     }
-    // update flags
-    clientlist_foreach(client_update_tag_flags, NULL);
 }
 
 void tag_update_flags() {
@@ -525,6 +526,8 @@ void tag_move_client(HSClient* client, HSTag* target) {
     frame_focus_client(target->frame, client);
     stack_remove_slice(client->tag->stack, client->slice);
     client->tag = target;
+    client_update_container(client);
+    state_client_changed(client);
     stack_insert_slice(client->tag->stack, client->slice);
     ewmh_window_update_tag(client->window, client->tag);
 
@@ -548,17 +551,166 @@ void tag_move_client(HSClient* client, HSTag* target) {
     tag_set_flags_dirty();
 }
 
+void tag_move_clients(HSClient** clients, size_t count, HSTag* target) {
+    HSMonitor* monitor_target = find_monitor_with_tag(target);
+    // the affected source tags, and whether each client was visible before
+    GArray* sources = g_array_new(false, false, sizeof(HSTag*));
+    bool* was_visible = g_new(bool, count);
+    size_t moved = 0;
+    for (size_t i = 0; i < count; i++) {
+        HSClient* client = clients[i];
+        HSTag* source = client->tag;
+        if (source == target) {
+            continue;
+        }
+        int j;
+        for (j = 0; j < sources->len; j++) {
+            if (g_array_index(sources, HSTag*, j) == source) {
+                break;
+            }
+        }
+        if (j == sources->len) {
+            g_array_append_val(sources, source);
+        }
+        was_visible[moved] = find_monitor_with_tag(source) != NULL;
+        // only mark it as moved, the frames and stacks are updated below
+        client->tag = target;
+        clients[moved++] = client;
+    }
+    if (moved == 0) {
+        g_array_free(sources, true);
+        g_free(was_visible);
+        return;
+    }
+    // remove all moved clients from each source tag in a single pass
+    for (int j = 0; j < sources->len; j++) {
+        HSTag* source = g_array_index(sources, HSTag*, j);
+        frame_remove_foreign_clients(source->frame);
+        stack_remove_foreign_slices(source->stack, source);
+    }
+    tag_insert_clients(clients, moved, target);
+
+    // relayout each affected monitor once and flush the mapping changes
+    // within a single server grab
+    monitors_lock();
+    client_visibility_begin();
+    for (size_t i = 0; i < moved; i++) {
+        if (was_visible[i] != (monitor_target != NULL)) {
+            client_set_visible(clients[i], monitor_target != NULL);
+        }
+    }
+    for (int j = 0; j < sources->len; j++) {
+        HSTag* source = g_array_index(sources, HSTag*, j);
+        monitor_apply_layout(find_monitor_with_tag(source));
+    }
+    monitor_apply_layout(monitor_target);
+    monitors_unlock();
+    client_visibility_end();
+    frame_focus_recursive(get_current_monitor()->tag->frame);
+    tag_set_flags_dirty();
+    g_array_free(sources, true);
+    g_free(was_visible);
+}
+
+typedef struct {
+    HSRule* rule;
+    GArray* clients; // the matching HSClient*
+} MatchingClients;
+
+static int collect_matching_client(HSClient* client, void* data) {
+    MatchingClients* matching = (MatchingClients*)data;
+    if (rule_matches(matching->rule, client)) {
+        g_array_append_val(matching->clients, client);
+    }
+    return 0;
+}
+
+int tag_move_windows_command(int argc, char** argv, GString* output) {
+    // usage: move_windows TAG [WINID|CONDITION ...]
+    if (argc < 3) {
+        return HERBST_NEED_MORE_ARGS;
+    }
+    HSTag* target = find_tag(argv[1]);
+    if (!target) {
+        g_string_append_printf(output,
+            "%s: Tag \"%s\" not found\n", argv[0], argv[1]);
+        return HERBST_INVALID_ARGUMENT;
+    }
+    GArray* clients = g_array_new(false, false, sizeof(HSClient*));
+    // not created by rule_create(), which would use up a rule label
+    HSRule* rule = g_new0(HSRule, 1);
+    rule->birth_time = get_monotonic_timestamp();
+    bool negated = false;
+    for (int i = 2; i < argc; i++) {
+        char* arg = argv[i];
+        bool is_condition = strpbrk(arg, "=~")
+                            || !strcmp(arg, "not") || !strcmp(arg, "!");
+        if (is_condition) {
+            if (!rule_parse_condition(rule, arg, &negated, output)) {
+                rule_destroy(rule);
+                g_array_free(clients, true);
+                return HERBST_INVALID_ARGUMENT;
+            }
+            continue;
+        }
+        HSClient* client = NULL;
+        string_to_client(arg, &client);
+        if (!client) {
+            g_string_append_printf(output,
+                "%s: Could not find client \"%s\".\n", argv[0], arg);
+            rule_destroy(rule);
+            g_array_free(clients, true);
+            return HERBST_INVALID_ARGUMENT;
+        }
+        g_array_append_val(clients, client);
+    }
+    if (rule->condition_count > 0) {
+        // collect the matching clients tag by tag, so the order is stable
+        for (int i = 0; i < g_tags->len; i++) {
+            HSTag* tag = g_array_index(g_tags, HSTag*, i);
+            if (tag == target) {
+                continue;
+            }
+            MatchingClients data = { rule, clients };
+            frame_foreach_client(tag->frame, collect_matching_client, &data);
+        }
+    }
+    rule_destroy(rule);
+    // drop duplicates
+    HSClient** buf = (HSClient**)clients->data;
+    size_t count = 0;
+    for (size_t i = 0; i < clients->len; i++) {
+        size_t j;
+        for (j = 0; j < count && buf[j] != buf[i]; j++) {
+        }
+        if (j == count) {
+            buf[count++] = buf[i];
+        }
+    }
+    tag_move_clients(buf, count, target);
+    g_array_free(clients, true);
+    return 0;
+}
+
 void tag_update_focus_layer(HSTag* tag) {
     HSClient* focus = frame_focused_client(tag->frame);
+    HSSlice* slice = NULL;
+    // enforce raise_on_focus_temporarily if there is at least one
+    // fullscreen window or if the tag is in tiling mode
+    if (focus && (!stack_is_layer_empty(tag->stack, LAYER_FULLSCREEN)
+                  || *g_raise_on_focus_temporarily
+                  || focus->tag->floating == false)) {
+        slice = focus->slice;
+    }
+    GList* layer = tag->stack->top[LAYER_FOCUS];
+    if (!stack_is_dirty(tag->stack)
+        && (slice ? (layer && !layer->next && layer->data == slice) : !layer)) {
+        // the focus layer is up to date, so nothing has to be restacked
+        return;
+    }
     stack_clear_layer(tag->stack, LAYER_FOCUS);
-    if (focus) {
-        // enforce raise_on_focus_temporarily if there is at least one
-        // fullscreen window or if the tag is in tiling mode
-        if (!stack_is_layer_empty(tag->stack, LAYER_FULLSCREEN)
-            || *g_raise_on_focus_temporarily
-            || focus->tag->floating == false) {
-            stack_slice_add_layer(tag->stack, focus->slice, LAYER_FOCUS);
-        }
+    if (slice) {
+        stack_slice_add_layer(tag->stack, slice, LAYER_FOCUS);
     }
     HSMonitor* monitor = find_monitor_with_tag(tag);
     if (monitor) {
@@ -585,3 +737,97 @@ void tag_update_focus_objects() {
     hsobject_link(g_tag_object, get_current_monitor()->tag->object, "focus");
 }
 
+static void tag_container_create(HSTag* tag) {
+    XSetWindowAttributes at;
+    // let transparent frames show the root window background
+    at.background_pixmap = ParentRelative;
+    at.override_redirect = True;
+    // it covers the entire screen but is clipped to the rect of its monitor,
+    // so that the children can keep their root window coordinates
+    tag->container = XCreateWindow(g_display, g_root, 0, 0,
+                        g_screen_width, g_screen_height, 0,
+                        CopyFromParent, InputOutput, CopyFromParent,
+                        CWOverrideRedirect | CWBackPixmap, &at);
+    tag->container_mapped = false;
+    tag->container_rect = Rectangle(0, 0, 0, 0);
+    window_clip_to_rect(tag->container, tag->container_rect);
+}
+
+Window tag_window_parent(HSTag* tag) {
+    return tag->container ? tag->container : g_root;
+}
+
+void tag_container_set_visible(HSTag* tag, bool visible) {
+    if (!tag->container || tag->container_mapped == visible) {
+        return;
+    }
+    if (visible) {
+        HSMonitor* m = find_monitor_with_tag(tag);
+        if (m) {
+            tag_container_set_rect(tag, monitor_container_rect(m));
+        }
+        XMapWindow(g_display, tag->container);
+    } else {
+        XUnmapWindow(g_display, tag->container);
+    }
+    tag->container_mapped = visible;
+}
+
+void tag_container_set_rect(HSTag* tag, Rectangle rect) {
+    if (!tag->container || rectangle_equals(tag->container_rect, rect)) {
+        return;
+    }
+    tag->container_rect = rect;
+    window_clip_to_rect(tag->container, rect);
+}
+
+void tag_containers_update_size() {
+    for (int i = 0; i < g_tags->len; i++) {
+        HSTag* tag = g_array_index(g_tags, HSTag*, i);
+        if (tag->container) {
+            XResizeWindow(g_display, tag->container,
+                          g_screen_width, g_screen_height);
+        }
+    }
+}
+
+static void frame_update_parent(HSFrame* frame, void* data) {
+    (void)data;
+    Window parent = tag_window_parent(frame->tag);
+    XReparentWindow(g_display, frame->window, parent,
+                    frame->last_rect.x, frame->last_rect.y);
+}
+
+static void client_update_parent(void* key, void* client, void* data) {
+    (void)key;
+    (void)data;
+    client_update_container((HSClient*)client);
+}
+
+void tag_update_containers() {
+    monitors_lock();
+    bool enabled = *g_tag_containers;
+    GArray* obsolete = g_array_new(false, false, sizeof(Window));
+    for (int i = 0; i < g_tags->len; i++) {
+        HSTag* tag = g_array_index(g_tags, HSTag*, i);
+        if (enabled && !tag->container) {
+            tag_container_create(tag);
+            tag_container_set_visible(tag, find_monitor_with_tag(tag) != NULL);
+        } else if (!enabled && tag->container) {
+            // destroy it after all children have been moved out
+            g_array_append_val(obsolete, tag->container);
+            tag->container = 0;
+            tag->container_mapped = false;
+        } else {
+            continue;
+        }
+        frame_do_recursive_data(tag->frame, frame_update_parent, 0, NULL);
+    }
+    clientlist_foreach(client_update_parent, NULL);
+    for (int i = 0; i < obsolete->len; i++) {
+        XDestroyWindow(g_display, g_array_index(obsolete, Window, i));
+    }
+    g_array_free(obsolete, true);
+    all_monitors_apply_layout();
+    monitors_unlock();
+}
@@ -8,10 +8,14 @@
 
 #include "glib-backports.h"
 #include <stdbool.h>
+#include <X11/Xlib.h>
+#include "x11-types.h"
 
 struct HSFrame;
 struct HSClient;
 struct HSStack;
+struct HSHistory;
+struct HSTrie;
 
 typedef struct HSTag {
     GString*        name;   // name of this tag
@@ -19,8 +23,18 @@ typedef struct HSTag {
     struct HSFrame* frame;  // the master frame
     bool            floating;
     int             flags;
+    int             frame_count;  // number of client frames
+    int             client_count; // number of clients in the frames
+    int             urgent_count; // number of urgent clients in the frames
     struct HSStack* stack;
     struct HSObject* object;
+    struct HSHistory* history; // undo/redo of layout changes
+    unsigned int    generation; // global generation of the last change
+    // if the setting tag_containers is enabled, all windows of the tag are
+    // children of this window, otherwise it is 0
+    Window          container;
+    bool            container_mapped;
+    Rectangle       container_rect; // the area the container is clipped to
 } HSTag;
 
 void tag_init();
@@ -29,6 +43,7 @@ void tag_destroy();
 // for tags
 HSTag* add_tag(const char* name);
 HSTag* find_tag(const char* name);
+struct HSTrie* tag_name_trie(); // for completion
 int    tag_index_of(HSTag* tag);
 HSTag* find_unused_tag();
 HSTag* find_tag_with_toplevel_frame(struct HSFrame* frame);
@@ -41,6 +56,9 @@ int tag_move_window_command(int argc, char** argv, GString* output);
 int tag_move_window_by_index_command(int argc, char** argv, GString* output);
 void tag_move_focused_client(HSTag* target);
 void tag_move_client(struct HSClient* client,HSTag* target);
+// moves all given clients to target at once. The array may be reordered.
+void tag_move_clients(struct HSClient** clients, size_t count, HSTag* target);
+int tag_move_windows_command(int argc, char** argv, GString* output);
 int tag_remove_command(int argc, char** argv, GString* output);
 int tag_set_floating_command(int argc, char** argv, GString* output);
 void tag_update_focus_layer(HSTag* tag);
@@ -52,5 +70,14 @@ void tag_update_flags();
 void tag_set_flags_dirty();
 void ensure_tags_are_available();
 
+// the window the windows of the tag are children of
+Window tag_window_parent(HSTag* tag);
+void tag_container_set_visible(HSTag* tag, bool visible);
+void tag_container_set_rect(HSTag* tag, Rectangle rect);
+// creates or removes the containers according to the setting tag_containers
+void tag_update_containers();
+// resizes the containers to the current screen size
+void tag_containers_update_size();
+
 #endif
 
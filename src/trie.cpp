@@ -0,0 +1,132 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#include "trie.h"
+
+#include "glib-backports.h"
+
+HSTrie* trie_create() {
+    HSTrie* trie = g_new0(HSTrie, 1);
+    return trie;
+}
+
+static void trie_node_free_children(HSTrieNode* node) {
+    HSTrieNode* child = node->child;
+    while (child) {
+        HSTrieNode* next = child->next;
+        trie_node_free_children(child);
+        g_free(child);
+        child = next;
+    }
+    node->child = NULL;
+}
+
+void trie_clear(HSTrie* trie) {
+    trie_node_free_children(&trie->root);
+    trie->size = 0;
+}
+
+void trie_destroy(HSTrie* trie) {
+    if (!trie) return;
+    trie_clear(trie);
+    g_free(trie);
+}
+
+// returns the address of the link that points to the child with character c
+// or of the link where such a child would have to be inserted
+static HSTrieNode** trie_node_child_link(HSTrieNode* node, char c) {
+    HSTrieNode** link = &node->child;
+    while (*link && (unsigned char)(*link)->c < (unsigned char)c) {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+static HSTrieNode* trie_find_node(HSTrie* trie, const char* key) {
+    HSTrieNode* node = &trie->root;
+    for (; node && *key; key++) {
+        HSTrieNode* child = *trie_node_child_link(node, *key);
+        node = (child && child->c == *key) ? child : NULL;
+    }
+    return node;
+}
+
+void trie_insert(HSTrie* trie, const char* key, void* data) {
+    HSTrieNode* node = &trie->root;
+    for (; *key; key++) {
+        HSTrieNode** link = trie_node_child_link(node, *key);
+        if (!*link || (*link)->c != *key) {
+            HSTrieNode* child = g_new0(HSTrieNode, 1);
+            child->c = *key;
+            child->next = *link;
+            *link = child;
+        }
+        node = *link;
+    }
+    if (!node->data) {
+        trie->size++;
+    }
+    node->data = data;
+}
+
+void* trie_lookup(HSTrie* trie, const char* key) {
+    HSTrieNode* node = trie_find_node(trie, key);
+    return node ? node->data : NULL;
+}
+
+// removes key below node, returns the old data and whether node became
+// useless
+static void* trie_node_remove(HSTrieNode* node, const char* key, bool* prune) {
+    void* data = NULL;
+    if (!*key) {
+        data = node->data;
+        node->data = NULL;
+    } else {
+        HSTrieNode** link = trie_node_child_link(node, *key);
+        if (*link && (*link)->c == *key) {
+            bool prune_child = false;
+            data = trie_node_remove(*link, key + 1, &prune_child);
+            if (prune_child) {
+                HSTrieNode* child = *link;
+                *link = child->next;
+                g_free(child);
+            }
+        }
+    }
+    *prune = !node->data && !node->child;
+    return data;
+}
+
+void* trie_remove(HSTrie* trie, const char* key) {
+    bool prune = false;
+    void* data = trie_node_remove(&trie->root, key, &prune);
+    if (data) {
+        trie->size--;
+    }
+    return data;
+}
+
+static void trie_node_foreach(HSTrieNode* node, GString* key,
+                              HSTrieAction action, void* user_data) {
+    if (node->data) {
+        action(key->str, node->data, user_data);
+    }
+    for (HSTrieNode* child = node->child; child; child = child->next) {
+        g_string_append_c(key, child->c);
+        trie_node_foreach(child, key, action, user_data);
+        g_string_truncate(key, key->len - 1);
+    }
+}
+
+void trie_foreach_prefix(HSTrie* trie, const char* prefix,
+                         HSTrieAction action, void* user_data) {
+    HSTrieNode* node = trie_find_node(trie, prefix ? prefix : "");
+    if (!node) {
+        return;
+    }
+    GString* key = g_string_new(prefix ? prefix : "");
+    trie_node_foreach(node, key, action, user_data);
+    g_string_free(key, true);
+}
@@ -0,0 +1,42 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+#ifndef __HERBSTLUFT_TRIE_H_
+#define __HERBSTLUFT_TRIE_H_
+
+#include <stdbool.h>
+
+// a prefix tree mapping strings to non-NULL data pointers, mainly used to
+// answer completion requests without scanning all candidates
+typedef struct HSTrieNode {
+    char                c;       // character of this node
+    void*               data;    // non-NULL if a key ends here
+    struct HSTrieNode*  child;   // first child
+    struct HSTrieNode*  next;    // next sibling, siblings are sorted by c
+} HSTrieNode;
+
+typedef struct HSTrie {
+    HSTrieNode  root;
+    int         size; // number of keys
+} HSTrie;
+
+typedef void (*HSTrieAction)(const char* key, void* data, void* user_data);
+
+HSTrie* trie_create();
+void trie_destroy(HSTrie* trie);
+void trie_clear(HSTrie* trie);
+
+// sets the data of key, replacing the old data if key already exists
+void trie_insert(HSTrie* trie, const char* key, void* data);
+// returns the data of key or NULL if key does not exist
+void* trie_lookup(HSTrie* trie, const char* key);
+// removes key and returns its old data, or NULL if it did not exist
+void* trie_remove(HSTrie* trie, const char* key);
+// calls action for each key starting with prefix, in ascending order
+void trie_foreach_prefix(HSTrie* trie, const char* prefix,
+                         HSTrieAction action, void* user_data);
+
+#endif
+
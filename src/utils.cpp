@@ -5,6 +5,7 @@
 
 #include "globals.h"
 #include "utils.h"
+#include "x11-utils.h"
 #include "settings.h"
 // standard
 #include <stdarg.h>
@@ -45,6 +46,23 @@ time_t get_monotonic_timestamp() {
     return ts.tv_sec;
 }
 
+// a timestamp in microseconds for measuring durations
+gint64 get_monotonic_usec() {
+    struct timespec ts;
+#if defined(__MACH__) && ! defined(CLOCK_MONOTONIC)
+    clock_serv_t cclock;
+    mach_timespec_t mts;
+    host_get_clock_service(mach_host_self(), SYSTEM_CLOCK, &cclock);
+    clock_get_time(cclock, &mts);
+    mach_port_deallocate(mach_task_self(), cclock);
+    ts.tv_sec = mts.tv_sec;
+    ts.tv_nsec = mts.tv_nsec;
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (gint64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 /// print a printf-like message to stderr and exit
 // from dwm.c
 void die(const char *errstr, ...) {
@@ -68,7 +86,7 @@ unsigned long getcolor(const char *colstr) {
 bool getcolor_error(const char *colstr, HSColor* ret_color) {
     Colormap cmap = DefaultColormap(g_display, g_screen);
     XColor color;
-    if(!XAllocNamedColor(g_display, cmap, colstr, &color, &color)) {
+    if(!X11_ROUND_TRIP(XAllocNamedColor(g_display, cmap, colstr, &color, &color))) {
         g_warning("error, cannot allocate color '%s'\n", colstr);
         return false;
     }
@@ -83,12 +101,12 @@ GString* window_property_to_g_string(Display* dpy, Window window, Atom atom) {
     int n = 0;
     XTextProperty prop;
 
-    if (0 == XGetTextProperty(dpy, window, &prop, atom)) {
+    if (0 == X11_ROUND_TRIP(XGetTextProperty(dpy, window, &prop, atom))) {
         return NULL;
     }
     // convert text property to a gstring
     if (prop.encoding == XA_STRING
-        || prop.encoding == XInternAtom(dpy, "UTF8_STRING", False)) {
+        || prop.encoding == ATOM("UTF8_STRING")) {
         result = g_string_new((char*)prop.value);
     } else {
         if (XmbTextPropertyToTextList(dpy, &prop, &list, &n) >= Success
@@ -104,7 +122,7 @@ GString* window_property_to_g_string(Display* dpy, Window window, Atom atom) {
 
 GString* window_class_to_g_string(Display* dpy, Window window) {
     XClassHint hint;
-    if (0 == XGetClassHint(dpy, window, &hint)) {
+    if (0 == X11_ROUND_TRIP(XGetClassHint(dpy, window, &hint))) {
         return g_string_new("");
     }
     GString* string = g_string_new(hint.res_class ? hint.res_class : "");
@@ -115,7 +133,7 @@ GString* window_class_to_g_string(Display* dpy, Window window) {
 
 GString* window_instance_to_g_string(Display* dpy, Window window) {
     XClassHint hint;
-    if (0 == XGetClassHint(dpy, window, &hint)) {
+    if (0 == X11_ROUND_TRIP(XGetClassHint(dpy, window, &hint))) {
         return g_string_new("");
     }
     GString* string = g_string_new(hint.res_name ? hint.res_name : "");
@@ -135,24 +153,24 @@ bool is_herbstluft_window(Display* dpy, Window window) {
 
 bool is_window_mapable(Display* dpy, Window window) {
     XWindowAttributes wa;
-    XGetWindowAttributes(dpy, window,  &wa);
+    X11_ROUND_TRIP(XGetWindowAttributes(dpy, window,  &wa));
     return (wa.map_state == IsUnmapped);
 }
 bool is_window_mapped(Display* dpy, Window window) {
     XWindowAttributes wa;
-    XGetWindowAttributes(dpy, window,  &wa);
+    X11_ROUND_TRIP(XGetWindowAttributes(dpy, window,  &wa));
     return (wa.map_state == IsViewable);
 }
 
 bool window_has_property(Display* dpy, Window window, char* prop_name) {
     // find the properties this window has
     int num_properties_ret;
-    Atom* properties= XListProperties(g_display, window, &num_properties_ret);
+    Atom* properties= X11_ROUND_TRIP(XListProperties(g_display, window, &num_properties_ret));
 
     bool atom_found = false;
     char* name;
     for(int i = 0; i < num_properties_ret; i++) {
-        name = XGetAtomName(g_display, properties[i]);
+        name = X11_ROUND_TRIP(XGetAtomName(g_display, properties[i]));
         if(!strcmp(prop_name, name)) {
             atom_found = true;
             break;
@@ -201,6 +219,11 @@ Rectangle parse_rectangle(char* string) {
     return rect;
 }
 
+bool rectangle_equals(Rectangle a, Rectangle b) {
+    return a.x == b.x && a.y == b.y
+        && a.width == b.width && a.height == b.height;
+}
+
 const char* strlasttoken(const char* str, const char* delim) {
     const char* next = str;
     while ((next = strpbrk(str, delim))) {
@@ -241,10 +264,10 @@ int window_pid(Display* dpy, Window window) {
     int format;
     unsigned long items, remain;
     int* buf;
-    int status = XGetWindowProperty(dpy, window,
+    int status = X11_ROUND_TRIP(XGetWindowProperty(dpy, window,
         ATOM("_NET_WM_PID"), 0, 1, False,
         XA_CARDINAL, &type, &format,
-        &items, &remain, (unsigned char**)&buf);
+        &items, &remain, (unsigned char**)&buf));
     if (items == 1 && format == 32 && remain == 0
         && type == XA_CARDINAL && status == Success) {
         int value = *buf;
@@ -340,25 +363,30 @@ void* table_find(void* start, size_t elem_size, size_t count,
 
 /**
  * \brief   emulates a double window border through the border pixmap mechanism
+ *
+ * The geometry of the window has to be passed by the caller, so no round trip
+ * to the X server is needed. The pixmap is kept in border and only redrawn if
+ * the geometry or the colors differ from the ones it was drawn with.
  */
-void set_window_double_border(Display *dpy, Window win, int ibw,
-                              unsigned long inner_color,
+void set_window_double_border(Display *dpy, Window win, HSDoubleBorder* border,
+                              int width, int height, int bw, unsigned int depth,
+                              int ibw, unsigned long inner_color,
                               unsigned long outer_color)
 {
-    XWindowAttributes wa;
-
-    if (!XGetWindowAttributes(dpy, win, &wa))
-        return;
-
-    int bw = wa.border_width;
-
     if (bw < 2 || ibw >= bw || ibw < 1)
         return;
 
-    int width = wa.width;
-    int height = wa.height;
-
-    unsigned int depth = wa.depth;
+    if (border->pixmap != None
+        && border->width == width
+        && border->height == height
+        && border->border_width == bw
+        && border->inner_width == ibw
+        && border->inner_color == inner_color
+        && border->outer_color == outer_color) {
+        // the window still has this border
+        return;
+    }
+    double_border_free(dpy, border);
 
     int full_width = width + 2 * bw;
     int full_height = height + 2 * bw;
@@ -402,11 +430,26 @@ void set_window_double_border(Display *dpy, Window win, int ibw,
 
     XSetWindowBorderPixmap(dpy, win, pix);
     XFreeGC(dpy, gc);
-    XFreePixmap(dpy, pix);
+
+    border->pixmap = pix;
+    border->width = width;
+    border->height = height;
+    border->border_width = bw;
+    border->inner_width = ibw;
+    border->inner_color = inner_color;
+    border->outer_color = outer_color;
+}
+
+// frees the pixmap, call it whenever the window border is set differently
+void double_border_free(Display *dpy, HSDoubleBorder* border) {
+    if (border->pixmap != None) {
+        XFreePixmap(dpy, border->pixmap);
+        border->pixmap = None;
+    }
 }
 
 void reload_tree_style() {
-    g_tree_style = settings_find_string("tree_style");
+    g_tree_style = settings_by_id(SETTING_TREE_STYLE)->value.str->str;
     if (g_utf8_strlen(g_tree_style, -1) < 8) {
         g_warning("too few characters in setting tree_style\n");
         // ensure that it is long enough
@@ -415,55 +458,67 @@ void reload_tree_style() {
     }
 }
 
-static void subtree_print_to(HSTreeInterface* intface, const char* indent,
-                          char* rootprefix, GString* output) {
-    HSTree root = intface->data;
-    size_t child_count = intface->child_count(root);
-    if (child_count == 0) {
-        g_string_append(output, rootprefix);
-        g_string_append_unichar(output, UTF8_STRING_AT(g_tree_style, 6));
-        g_string_append_unichar(output, UTF8_STRING_AT(g_tree_style, 5));
-        g_string_append_c(output, ' ');
-        // append caption
-        intface->append_caption(root, output);
-        g_string_append(output, "\n");
-    } else {
-        g_string_append_printf(output, "%s", rootprefix);
-        g_string_append_unichar(output, UTF8_STRING_AT(g_tree_style, 6));
-        g_string_append_unichar(output, UTF8_STRING_AT(g_tree_style, 7));
-        // append caption
-        g_string_append_c(output, ' ');
-        intface->append_caption(root, output);
-        g_string_append_c(output, '\n');
-        // append children
-        GString* child_indent = g_string_new("");
-        GString* child_prefix = g_string_new("");
-        for (size_t i = 0; i < child_count; i++) {
-            bool last = (i == child_count - 1);
-            g_string_printf(child_indent, "%s ", indent);
-            g_string_append_unichar(child_indent,
-                UTF8_STRING_AT(g_tree_style, last ? 2 : 1));
-            g_string_printf(child_prefix, "%s ", indent);
-            g_string_append_unichar(child_prefix,
-                UTF8_STRING_AT(g_tree_style, last ? 4 : 3));
-            HSTreeInterface child = intface->nth_child(root, i);
-            subtree_print_to(&child, child_indent->str,
-                             child_prefix->str, output);
-            if (child.destructor) {
-                child.destructor(child.data);
-            }
-        }
-        g_string_free(child_indent, true);
-        g_string_free(child_prefix, true);
+struct HSTreePrinter {
+    GString*    indent; // indentation of the current children, shared
+    GString*    output;
+    size_t      count;  // number of children of the current node
+    size_t      index;  // number of children printed so far
+};
+
+static void tree_print_caption(HSTreeInterface* intface, bool has_children,
+                               GString* output) {
+    g_string_append_unichar(output, UTF8_STRING_AT(g_tree_style, 6));
+    g_string_append_unichar(output,
+        UTF8_STRING_AT(g_tree_style, has_children ? 7 : 5));
+    g_string_append_c(output, ' ');
+    intface->append_caption(intface->data, output);
+    g_string_append_c(output, '\n');
+}
 
+static void tree_print_children(HSTreeInterface* intface, size_t count,
+                                GString* indent, GString* output);
+
+static void tree_print_child(HSTreeInterface* child, void* data) {
+    struct HSTreePrinter* p = (struct HSTreePrinter*) data;
+    bool last = (++p->index == p->count);
+    size_t indent_len = p->indent->len;
+    size_t child_count = child->child_count(child->data);
+    g_string_append_len(p->output, p->indent->str, indent_len);
+    g_string_append_c(p->output, ' ');
+    g_string_append_unichar(p->output,
+        UTF8_STRING_AT(g_tree_style, last ? 4 : 3));
+    tree_print_caption(child, child_count > 0, p->output);
+    if (child_count > 0) {
+        // the children of child are indented by one more level
+        g_string_append_c(p->indent, ' ');
+        g_string_append_unichar(p->indent,
+            UTF8_STRING_AT(g_tree_style, last ? 2 : 1));
+        tree_print_children(child, child_count, p->indent, p->output);
+        g_string_truncate(p->indent, indent_len);
     }
+    if (child->destructor) {
+        child->destructor(child->data);
+    }
+}
+
+static void tree_print_children(HSTreeInterface* intface, size_t count,
+                                GString* indent, GString* output) {
+    struct HSTreePrinter printer = { indent, output, count, 0 };
+    intface->foreach_child(intface->data, tree_print_child, &printer);
 }
 
+/* prints the tree in linear time. All lines share the same indentation
+ * buffer, which is extended when descending and truncated when ascending.
+ */
 void tree_print_to(HSTreeInterface* intface, GString* output) {
-    GString* root_indicator = g_string_new("");
-    g_string_append_unichar(root_indicator, UTF8_STRING_AT(g_tree_style, 0));
-    subtree_print_to(intface, " ", root_indicator->str, output);
-    g_string_free(root_indicator, true);
+    size_t child_count = intface->child_count(intface->data);
+    g_string_append_unichar(output, UTF8_STRING_AT(g_tree_style, 0));
+    tree_print_caption(intface, child_count > 0, output);
+    if (child_count > 0) {
+        GString* indent = g_string_new(" ");
+        tree_print_children(intface, child_count, indent, output);
+        g_string_free(indent, true);
+    }
 }
 
 int min(int a, int b) {
@@ -551,3 +606,22 @@ void posix_sh_compress_inplace(char* str) {
     }
 }
 
+void json_append_string(GString* output, const char* str) {
+    g_string_append_c(output, '"');
+    for (const char* c = str; *c; c++) {
+        switch (*c) {
+            case '"':  g_string_append(output, "\\\""); break;
+            case '\\': g_string_append(output, "\\\\"); break;
+            case '\n': g_string_append(output, "\\n"); break;
+            case '\t': g_string_append(output, "\\t"); break;
+            default:
+                if ((unsigned char)*c < 0x20) {
+                    g_string_append_printf(output, "\\u%04x", *c);
+                } else {
+                    g_string_append_c(output, *c);
+                }
+                break;
+        }
+    }
+    g_string_append_c(output, '"');
+}
@@ -12,6 +12,7 @@
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
 #include "x11-types.h"
+#include "atoms.h"
 #include <array>
 
 #define LENGTH(X) (sizeof(X)/sizeof(*X))
@@ -36,7 +37,7 @@ void die(const char *errstr, ...);
 HSColor getcolor(const char *colstr);
 bool getcolor_error(const char *colstr, HSColor* color);
 
-#define ATOM(A) XInternAtom(g_display, (A), False)
+#define ATOM(A) atom_get(A)
 
 GString* window_property_to_g_string(Display* dpy, Window window, Atom atom);
 GString* window_class_to_g_string(Display* dpy, Window window);
@@ -45,8 +46,12 @@ int window_pid(Display* dpy, Window window);
 
 typedef void* HSTree;
 struct HSTreeInterface;
+typedef void (*HSTreeChildAction)(struct HSTreeInterface* child, void* data);
 typedef struct HSTreeInterface {
-    struct HSTreeInterface  (*nth_child)(HSTree root, size_t idx);
+    /* calls action for each child of root in order */
+    void                    (*foreach_child)(HSTree root,
+                                             HSTreeChildAction action,
+                                             void* data);
     size_t                  (*child_count)(HSTree root);
     void                    (*append_caption)(HSTree root, GString* output);
     HSTree                  data;
@@ -70,6 +75,7 @@ bool string_to_bool(const char* string, bool oldvalue);
 const char* strlasttoken(const char* str, const char* delim);
 
 time_t get_monotonic_timestamp();
+gint64 get_monotonic_usec();
 
 // duplicates an argument-vector
 char** argv_duplicate(int argc, char** argv);
@@ -77,6 +83,7 @@ char** argv_duplicate(int argc, char** argv);
 void argv_free(int argc, char** argv);
 
 Rectangle parse_rectangle(char* string);
+bool rectangle_equals(Rectangle a, Rectangle b);
 
 void g_queue_remove_element(GQueue* queue, GList* elem);
 
@@ -104,8 +111,22 @@ bool memberequals_int(void* pmember, const void* needle);
 void* table_find(void* start, size_t elem_size, size_t count,
                  size_t member_offset, MemberEquals equals, const void* needle);
 
-void set_window_double_border(Display *dpy, Window win, int ibw,
-                              unsigned long inner_color, unsigned long outer_color);
+// the border pixmap of a window and the parameters it was drawn with
+typedef struct {
+    Pixmap          pixmap; // None if the window has no such border
+    int             width;
+    int             height;
+    int             border_width;
+    int             inner_width;
+    unsigned long   inner_color;
+    unsigned long   outer_color;
+} HSDoubleBorder;
+
+void set_window_double_border(Display *dpy, Window win, HSDoubleBorder* border,
+                              int width, int height, int bw, unsigned int depth,
+                              int ibw, unsigned long inner_color,
+                              unsigned long outer_color);
+void double_border_free(Display *dpy, HSDoubleBorder* border);
 
 #define STATIC_TABLE_FIND(TYPE, TABLE, MEMBER, EQUALS, NEEDLE)  \
     ((TYPE*) table_find((TABLE),                                \
@@ -139,5 +160,8 @@ char* posix_sh_escape(const char* source);
 // does the reverse action to posix_sh_escape by modifing the string
 void posix_sh_compress_inplace(char* str);
 
+// appends str as a quoted and escaped JSON string to output
+void json_append_string(GString* output, const char* str);
+
 #endif
 
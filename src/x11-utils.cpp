@@ -2,6 +2,7 @@
 
 #include "x11-utils.h"
 #include "globals.h"
+#include "utils.h"
 #include <stdio.h>
 
 #include<X11/extensions/shape.h>
@@ -11,67 +12,61 @@
  * a frame of width framewidth remains
  */
 void window_cut_rect_hole(Window win, int width, int height, int framewidth) {
-    // inspired by the xhole.c example
-    // http://www.answers.com/topic/xhole-c
-    Display* d = g_display;
-    GC gp;
-    int bw = 100; // add a large border, just to be sure the border is visible
+    // the shape is slightly larger than the window to allow for the window
+    // border to be visible
+    int bw = 100;
+    framewidth = MAX(0, framewidth);
     int holewidth = width - 2*framewidth;
     int holeheight = height - 2*framewidth;
-    width += 2*bw;
-    height += 2*bw;
-
-    /* create the pixmap that specifies the shape */
-    Pixmap p = XCreatePixmap(d, win, width, height, 1);
-    gp = XCreateGC(d, p, 0, NULL);
-    XSetForeground(d, gp, WhitePixel(d, g_screen));
-    XFillRectangle(d, p, gp, 0, 0, width, height);
-    XSetForeground(d, gp, BlackPixel(d, g_screen));
-    //int radius = 50;
-    //XFillArc(d, p, gp,
-    //         width/2 - radius, height/2 - radius, radius, radius,
-    //         0, 360*64);
-    XFillRectangle(d, p, gp, bw + framewidth, bw + framewidth,
-                             holewidth, holeheight);
-
-    /* set the pixmap as the new window mask;
-    the pixmap is slightly larger than the window to allow for the window
-    border and title bar (as added by the window manager) to be visible */
-    XShapeCombineMask(d, win, ShapeBounding, -bw, -bw, p, ShapeSet);
-    XFreeGC(d, gp);
-    XFreePixmap(d, p);
+    if (holewidth <= 0 || holeheight <= 0) {
+        // nothing remains to be cut out
+        XRectangle all = { (short)-bw, (short)-bw,
+                           (unsigned short)(width + 2*bw),
+                           (unsigned short)(height + 2*bw) };
+        XShapeCombineRectangles(g_display, win, ShapeBounding, 0, 0,
+                                &all, 1, ShapeSet, YXBanded);
+        return;
+    }
+    // the remaining frame around the hole, as bands from top to bottom
+    XRectangle rects[] = {
+        // top
+        { (short)-bw, (short)-bw,
+          (unsigned short)(width + 2*bw), (unsigned short)(bw + framewidth) },
+        // left and right
+        { (short)-bw, (short)framewidth,
+          (unsigned short)(bw + framewidth), (unsigned short)holeheight },
+        { (short)(width - framewidth), (short)framewidth,
+          (unsigned short)(bw + framewidth), (unsigned short)holeheight },
+        // bottom
+        { (short)-bw, (short)(height - framewidth),
+          (unsigned short)(width + 2*bw), (unsigned short)(bw + framewidth) },
+    };
+    XShapeCombineRectangles(g_display, win, ShapeBounding, 0, 0,
+                            rects, LENGTH(rects), ShapeSet, YXBanded);
 }
 
-void window_make_intransparent(Window win, int width, int height) {
-    // inspired by the xhole.c example
-    // http://www.answers.com/topic/xhole-c
-    Display* d = g_display;
-    GC gp;
-    int bw = 100; // add a large border, just to be sure the border is visible
-    width += 2*bw;
-    height += 2*bw;
-
-    /* create the pixmap that specifies the shape */
-    Pixmap p = XCreatePixmap(d, win, width, height, 1);
-    gp = XCreateGC(d, p, 0, NULL);
-    XSetForeground(d, gp, WhitePixel(d, g_screen));
-    XFillRectangle(d, p, gp, 0, 0, width, height);
-    /* set the pixmap as the new window mask;
-    the pixmap is slightly larger than the window to allow for the window
-    border and title bar (as added by the window manager) to be visible */
-    XShapeCombineMask(d, win, ShapeBounding, -bw, -bw, p, ShapeSet);
-    XFreeGC(d, gp);
-    XFreePixmap(d, p);
+void window_make_intransparent(Window win) {
+    // removing the mask restores the default shape, i.e. the window including
+    // its border, without having to build a mask for it
+    XShapeCombineMask(g_display, win, ShapeBounding, 0, 0, None, ShapeSet);
 }
 
+// clips the window to the given rect, relative to the window
+void window_clip_to_rect(Window win, Rectangle rect) {
+    XRectangle r = { (short)rect.x, (short)rect.y,
+                     (unsigned short)MAX(0, rect.width),
+                     (unsigned short)MAX(0, rect.height) };
+    XShapeCombineRectangles(g_display, win, ShapeBounding, 0, 0,
+                            &r, 1, ShapeSet, YXBanded);
+}
 
 Point2D get_cursor_position() {
     Point2D point;
     Window win, child;
     int wx, wy;
     unsigned int mask;
-    if (True != XQueryPointer(g_display, g_root, &win, &child,
-                              &point.x, &point.y, &wx,&wy, &mask)) {
+    if (True != X11_ROUND_TRIP(XQueryPointer(g_display, g_root, &win, &child,
+                              &point.x, &point.y, &wx,&wy, &mask))) {
         HSWarning("Can not query cursor coordinates via XQueryPointer\n");
         point.x = 0;
         point.y = 0;
@@ -8,14 +8,31 @@
 #include <X11/Xatom.h>
 
 #include "x11-types.h"
+#include "stats.h"
 
 
 // cut a rect out of the window, s.t. the window has geometry rect and a frame
 // of width framewidth remains
 void window_cut_rect_hole(Window win, int width, int height, int framewidth);
-void window_make_intransparent(Window win, int width, int height);
+void window_make_intransparent(Window win);
+void window_clip_to_rect(Window win, Rectangle rect);
 
 Point2D get_cursor_position();
 
+// wraps a blocking X call, i.e. one that waits for a reply of the X server,
+// and accounts its round trip and requests to the call site. The counts are
+// available in the stats.x11 object and via the profile command.
+#define X11_ROUND_TRIP(CALL) \
+    (stats_round_trip_begin([]() -> HSXCallSite* { \
+            static HSXCallSite site = { __FILE__, __LINE__ }; \
+            return &site; \
+        }(), __func__), \
+     x11_round_trip_end(CALL))
+
+template<typename T> inline T x11_round_trip_end(T result) {
+    stats_round_trip_end();
+    return result;
+}
+
 #endif
 
@@ -0,0 +1,189 @@
+/** Copyright 2011-2013 Thorsten Wißmann. All rights reserved.
+ *
+ * This software is licensed under the "Simplified BSD License".
+ * See LICENSE for details */
+
+/* property based tests of the layout computations. Like
+ * benchmark/bench-layout.cpp, it only links the X-free layout core and thus
+ * runs without an X server. Each property is checked on random inputs; on
+ * failure, the input is printed together with the seed, such that the
+ * failure can be reproduced with -s SEED.
+ *
+ * By default, a fixed seed is used, so every run checks the same inputs.
+ * With -r, a random seed is used to explore other inputs.
+ *
+ * usage: test-layout [-n ROUNDS] [-s SEED | -r]
+ */
+
+#include "layout-engine.h"
+#include "geometry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vector>
+
+#define DEFAULT_SEED 1
+
+static unsigned int g_seed;
+static int g_failures = 0;
+
+#define CHECK(COND, ...) \
+    do { \
+        if (!(COND)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n  ", \
+                    __FILE__, __LINE__, #COND); \
+            fprintf(stderr, __VA_ARGS__); \
+            fprintf(stderr, " (seed %u)\n", g_seed); \
+            g_failures++; \
+            return; \
+        } \
+    } while (0)
+
+#define RECT_FMT "%dx%d%+d%+d"
+#define RECT_ARGS(R) (R).width, (R).height, (R).x, (R).y
+
+// returns a random number in [lo, hi]
+static int random_int(int lo, int hi) {
+    return lo + rand() % (hi - lo + 1);
+}
+
+static Rectangle random_rect() {
+    return Rectangle(random_int(-2000, 2000), random_int(-2000, 2000),
+                     random_int(0, 4000), random_int(0, 4000));
+}
+
+static long long area(Rectangle r) {
+    return (long long)r.width * r.height;
+}
+
+static bool rect_inside(Rectangle inner, Rectangle outer) {
+    return inner.width >= 0 && inner.height >= 0
+        && inner.x >= outer.x && inner.y >= outer.y
+        && inner.x + inner.width <= outer.x + outer.width
+        && inner.y + inner.height <= outer.y + outer.height;
+}
+
+static bool rects_overlap(Rectangle a, Rectangle b) {
+    return intervals_intersect(a.x, a.x + a.width, b.x, b.x + b.width)
+        && intervals_intersect(a.y, a.y + a.height, b.y, b.y + b.height)
+        && area(a) > 0 && area(b) > 0;
+}
+
+// the rects of the count clients are within the frame and do not overlap.
+// If cover is set, they also cover the entire frame
+static void check_layout(int layout, bool gapless, bool cover) {
+    Rectangle frame = random_rect();
+    HSLayoutParams params;
+    params.count = random_int(1, 50);
+    params.selection = 0;
+    params.gapless_grid = gapless;
+    std::vector<Rectangle> rects(params.count);
+    layout_engine(layout)->compute(frame, &params, rects.data());
+    long long sum = 0;
+    for (size_t i = 0; i < params.count; i++) {
+        CHECK(rect_inside(rects[i], frame),
+              "layout %s: client %zu of %zu at " RECT_FMT
+              " outside of " RECT_FMT, g_layout_names[layout], i,
+              params.count, RECT_ARGS(rects[i]), RECT_ARGS(frame));
+        for (size_t j = 0; j < i; j++) {
+            CHECK(!rects_overlap(rects[i], rects[j]),
+                  "layout %s: clients %zu and %zu of %zu overlap in "
+                  RECT_FMT, g_layout_names[layout], j, i, params.count,
+                  RECT_ARGS(frame));
+        }
+        sum += area(rects[i]);
+    }
+    // without overlaps, the frame is covered iff the areas sum up
+    CHECK(!cover || sum == area(frame),
+          "layout %s: %zu clients cover %lld of %lld pixels of " RECT_FMT,
+          g_layout_names[layout], params.count, sum, area(frame),
+          RECT_ARGS(frame));
+}
+
+static void check_split() {
+    Rectangle rect = random_rect();
+    bool vertical = random_int(0, 1);
+    int fraction = random_int(0, FRACTION_UNIT);
+    Rectangle first, second;
+    layout_split(rect, vertical, fraction, &first, &second);
+    CHECK(rect_inside(first, rect) && rect_inside(second, rect),
+          "split of " RECT_FMT " at %d is outside", RECT_ARGS(rect), fraction);
+    CHECK(!rects_overlap(first, second),
+          "split of " RECT_FMT " at %d overlaps", RECT_ARGS(rect), fraction);
+    CHECK(area(first) + area(second) == area(rect),
+          "split of " RECT_FMT " at %d into " RECT_FMT " and " RECT_FMT
+          " changes the area", RECT_ARGS(rect), fraction,
+          RECT_ARGS(first), RECT_ARGS(second));
+}
+
+static void check_size_hints() {
+    HSSizeHints hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.basew = random_int(0, 100);
+    hints.baseh = random_int(0, 100);
+    hints.minw = random_int(0, 1) ? hints.basew : random_int(0, 300);
+    hints.minh = random_int(0, 1) ? hints.baseh : random_int(0, 300);
+    hints.maxw = random_int(0, 1) ? 0 : random_int(hints.minw, 3000);
+    hints.maxh = random_int(0, 1) ? 0 : random_int(hints.minh, 3000);
+    hints.incw = random_int(0, 1) ? 0 : random_int(1, 30);
+    hints.inch = random_int(0, 1) ? 0 : random_int(1, 30);
+    int w_in = random_int(-100, 4000);
+    int h_in = random_int(-100, 4000);
+    int w = w_in, h = h_in;
+    size_hints_apply(&hints, &w, &h);
+    CHECK(w >= hints.minw && h >= hints.minh,
+          "%dx%d with min %dx%d gives %dx%d", w_in, h_in,
+          hints.minw, hints.minh, w, h);
+    CHECK((!hints.maxw || w <= hints.maxw) && (!hints.maxh || h <= hints.maxh),
+          "%dx%d with max %dx%d gives %dx%d", w_in, h_in,
+          hints.maxw, hints.maxh, w, h);
+    // the increments only hold if the size is not clamped to min or max
+    CHECK(!hints.incw || w == hints.minw || w == hints.maxw
+          || (w - hints.basew) % hints.incw == 0,
+          "%d with base %d and increment %d gives %d", w_in,
+          hints.basew, hints.incw, w);
+    CHECK(!hints.inch || h == hints.minh || h == hints.maxh
+          || (h - hints.baseh) % hints.inch == 0,
+          "%d with base %d and increment %d gives %d", h_in,
+          hints.baseh, hints.inch, h);
+}
+
+int main(int argc, char** argv) {
+    int rounds = 10000;
+    g_seed = DEFAULT_SEED;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:r")) != -1) {
+        switch (opt) {
+            case 'n':
+                rounds = atoi(optarg);
+                break;
+            case 's':
+                g_seed = strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                g_seed = time(NULL);
+                break;
+            default:
+                return EXIT_FAILURE;
+        }
+    }
+    srand(g_seed);
+    for (int i = 0; i < rounds; i++) {
+        check_layout(LAYOUT_VERTICAL, false, true);
+        check_layout(LAYOUT_HORIZONTAL, false, true);
+        check_layout(LAYOUT_GRID, true, true);
+        check_layout(LAYOUT_GRID, false, false);
+        check_split();
+        check_size_hints();
+    }
+    if (g_failures > 0) {
+        fprintf(stderr, "%d checks failed in %d rounds\n", g_failures, rounds);
+        return EXIT_FAILURE;
+    }
+    printf("all %d rounds passed (seed %u)\n", rounds, g_seed);
+    return EXIT_SUCCESS;
+}